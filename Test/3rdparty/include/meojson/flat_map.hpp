@@ -0,0 +1,364 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace json
+{
+// What flat_map iterators dereference to: a pair of references to the key and
+// to the mapped value. It is a type of its own only so that std::common_reference
+// can relate it to flat_map::value_type, which std::pair only gets in C++23.
+template <typename key_t, typename mapped_ref_t>
+struct flat_map_entry : std::pair<const key_t&, mapped_ref_t>
+{
+    using std::pair<const key_t&, mapped_ref_t>::pair;
+};
+
+// A sorted-vector associative container exposing the subset of the std::map
+// interface used by basic_object. Keys and mapped values live in two parallel
+// vectors, so lookups are a cache-friendly binary search over the keys alone
+// instead of a red-black tree walk.
+//
+// Iterators dereference to a flat_map_entry, a pair of references, rather than
+// to a stored pair: the keys can't be modified through them, which would
+// break the sort order. Bind entries with `const auto&` or `auto&&`, not
+// `auto&`. Unlike std::map, inserting or erasing invalidates iterators and
+// references to other entries.
+template <typename key_t, typename mapped_t, typename compare_t = std::less<>>
+class flat_map
+{
+    template <bool is_const>
+    class iterator_base;
+
+public:
+    using key_type = key_t;
+    using mapped_type = mapped_t;
+    using value_type = std::pair<const key_t, mapped_t>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = flat_map_entry<key_t, mapped_t&>;
+    using const_reference = flat_map_entry<key_t, const mapped_t&>;
+    using iterator = iterator_base<false>;
+    using const_iterator = iterator_base<true>;
+    using key_compare = compare_t;
+
+public:
+    flat_map() = default;
+    flat_map(const flat_map&) = default;
+    flat_map(flat_map&&) noexcept = default;
+    flat_map(std::initializer_list<value_type> init_list) { insert(init_list.begin(), init_list.end()); }
+    template <typename input_iter_t>
+    flat_map(input_iter_t first, input_iter_t last)
+    {
+        insert(first, last);
+    }
+
+    ~flat_map() = default;
+
+    flat_map& operator=(const flat_map&) = default;
+    flat_map& operator=(flat_map&&) noexcept = default;
+
+    bool empty() const noexcept { return _keys.empty(); }
+    size_type size() const noexcept { return _keys.size(); }
+    void reserve(size_type n)
+    {
+        _keys.reserve(n);
+        _values.reserve(n);
+    }
+    void clear() noexcept
+    {
+        _keys.clear();
+        _values.clear();
+    }
+
+    iterator begin() noexcept { return make_iterator(0); }
+    iterator end() noexcept { return make_iterator(size()); }
+    const_iterator begin() const noexcept { return make_iterator(0); }
+    const_iterator end() const noexcept { return make_iterator(size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    template <typename lookup_t>
+    iterator find(const lookup_t& key)
+    {
+        return make_iterator(find_index(key));
+    }
+    template <typename lookup_t>
+    const_iterator find(const lookup_t& key) const
+    {
+        return make_iterator(find_index(key));
+    }
+    template <typename lookup_t>
+    bool contains(const lookup_t& key) const
+    {
+        return find_index(key) != size();
+    }
+    template <typename lookup_t>
+    size_type count(const lookup_t& key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    template <typename lookup_t>
+    mapped_t& at(const lookup_t& key)
+    {
+        auto index = find_index(key);
+        if (index == size()) {
+            throw std::out_of_range("json::flat_map::at");
+        }
+        return _values[index];
+    }
+    template <typename lookup_t>
+    const mapped_t& at(const lookup_t& key) const
+    {
+        auto index = find_index(key);
+        if (index == size()) {
+            throw std::out_of_range("json::flat_map::at");
+        }
+        return _values[index];
+    }
+
+    mapped_t& operator[](const key_t& key) { return try_emplace(key).first->second; }
+    mapped_t& operator[](key_t&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // Same semantics as std::map::try_emplace: an existing entry is never overwritten.
+    template <typename key_arg_t, typename... args_t>
+    std::pair<iterator, bool> try_emplace(key_arg_t&& key, args_t&&... args)
+    {
+        size_type index = size();
+        // appending in key order is the common case when parsing or copying sorted input
+        if (!_keys.empty() && !key_less(_keys.back(), key)) {
+            index = lower_bound(key);
+            if (index != size() && !key_less(key, _keys[index])) {
+                return { make_iterator(index), false };
+            }
+        }
+        _values.emplace(_values.begin() + index, std::forward<args_t>(args)...);
+        try {
+            _keys.emplace(_keys.begin() + index, std::forward<key_arg_t>(key));
+        }
+        catch (...) {
+            _values.erase(_values.begin() + index);
+            throw;
+        }
+        return { make_iterator(index), true };
+    }
+
+    template <typename... args_t>
+    std::pair<iterator, bool> emplace(args_t&&... args)
+    {
+        std::pair<key_t, mapped_t> val(std::forward<args_t>(args)...);
+        return try_emplace(std::move(val.first), std::move(val.second));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& val) { return try_emplace(val.first, val.second); }
+    std::pair<iterator, bool> insert(value_type&& val) { return try_emplace(val.first, std::move(val.second)); }
+    template <typename input_iter_t>
+    void insert(input_iter_t first, input_iter_t last)
+    {
+        for (; first != last; ++first) {
+            emplace(*first);
+        }
+    }
+
+    iterator erase(const_iterator iter) { return erase_index(iter._index); }
+    iterator erase(iterator iter) { return erase_index(iter._index); }
+    template <typename lookup_t>
+    size_type erase(const lookup_t& key)
+    {
+        auto index = find_index(key);
+        if (index == size()) {
+            return 0;
+        }
+        erase_index(index);
+        return 1;
+    }
+
+    bool operator==(const flat_map& rhs) const { return _keys == rhs._keys && _values == rhs._values; }
+    bool operator!=(const flat_map& rhs) const { return !(*this == rhs); }
+
+private:
+    iterator make_iterator(size_type index) noexcept { return iterator(_keys.data(), _values.data(), index); }
+    const_iterator make_iterator(size_type index) const noexcept
+    {
+        return const_iterator(_keys.data(), _values.data(), index);
+    }
+
+    iterator erase_index(size_type index)
+    {
+        _keys.erase(_keys.begin() + index);
+        _values.erase(_values.begin() + index);
+        return make_iterator(index);
+    }
+
+    template <typename lookup_t>
+    size_type lower_bound(const lookup_t& key) const
+    {
+        auto iter = std::lower_bound(_keys.cbegin(), _keys.cend(), key,
+                                     [](const key_t& lhs, const lookup_t& rhs) { return key_less(lhs, rhs); });
+        return static_cast<size_type>(iter - _keys.cbegin());
+    }
+    // size() if not found
+    template <typename lookup_t>
+    size_type find_index(const lookup_t& key) const
+    {
+        auto index = lower_bound(key);
+        return index != size() && !key_less(key, _keys[index]) ? index : size();
+    }
+
+    template <typename lhs_t, typename rhs_t>
+    static bool key_less(const lhs_t& lhs, const rhs_t& rhs)
+    {
+        return compare_t {}(lhs, rhs);
+    }
+
+private:
+    std::vector<key_t> _keys;
+    std::vector<mapped_t> _values;
+};
+
+// Random access over both vectors at once. operator-> hands out a pointer to a
+// proxy held by the returned object, so `iter->second` works like on std::map.
+template <typename key_t, typename mapped_t, typename compare_t>
+template <bool is_const>
+class flat_map<key_t, mapped_t, compare_t>::iterator_base
+{
+    friend class flat_map;
+    friend class iterator_base<!is_const>;
+
+    using mapped_ptr = std::conditional_t<is_const, const mapped_t*, mapped_t*>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = flat_map::value_type;
+    using difference_type = ptrdiff_t;
+    using reference = std::conditional_t<is_const, const_reference, flat_map::reference>;
+
+    class pointer
+    {
+    public:
+        const reference* operator->() const noexcept { return &_ref; }
+
+    private:
+        friend class iterator_base;
+        explicit pointer(reference ref) noexcept : _ref(ref) {}
+
+        reference _ref;
+    };
+
+public:
+    iterator_base() = default;
+    // iterator to const_iterator
+    template <bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+    iterator_base(const iterator_base<other_const>& rhs) noexcept
+        : _keys(rhs._keys), _values(rhs._values), _index(rhs._index)
+    {
+    }
+
+    reference operator*() const noexcept { return reference(_keys[_index], _values[_index]); }
+    reference operator[](difference_type n) const noexcept { return *(*this + n); }
+    pointer operator->() const noexcept { return pointer(**this); }
+
+    // moving out of an entry moves the mapped value, the key stays const like in std::map
+    friend flat_map_entry<key_t, std::conditional_t<is_const, const mapped_t&&, mapped_t&&>>
+        iter_move(const iterator_base& iter) noexcept
+    {
+        return { iter._keys[iter._index], std::move(iter._values[iter._index]) };
+    }
+
+    iterator_base& operator++() noexcept
+    {
+        ++_index;
+        return *this;
+    }
+    iterator_base operator++(int) noexcept { return iterator_base(_keys, _values, _index++); }
+    iterator_base& operator--() noexcept
+    {
+        --_index;
+        return *this;
+    }
+    iterator_base operator--(int) noexcept { return iterator_base(_keys, _values, _index--); }
+    iterator_base& operator+=(difference_type n) noexcept
+    {
+        _index += n;
+        return *this;
+    }
+    iterator_base& operator-=(difference_type n) noexcept
+    {
+        _index -= n;
+        return *this;
+    }
+    iterator_base operator+(difference_type n) const noexcept { return iterator_base(_keys, _values, _index + n); }
+    iterator_base operator-(difference_type n) const noexcept { return iterator_base(_keys, _values, _index - n); }
+    friend iterator_base operator+(difference_type n, const iterator_base& iter) noexcept { return iter + n; }
+    // friends, so that an iterator and a const_iterator can be mixed
+    friend difference_type operator-(const iterator_base& lhs, const iterator_base& rhs) noexcept
+    {
+        return static_cast<difference_type>(lhs._index) - static_cast<difference_type>(rhs._index);
+    }
+    friend bool operator==(const iterator_base& lhs, const iterator_base& rhs) noexcept
+    {
+        return lhs._index == rhs._index;
+    }
+    friend bool operator!=(const iterator_base& lhs, const iterator_base& rhs) noexcept
+    {
+        return lhs._index != rhs._index;
+    }
+    friend bool operator<(const iterator_base& lhs, const iterator_base& rhs) noexcept
+    {
+        return lhs._index < rhs._index;
+    }
+    friend bool operator>(const iterator_base& lhs, const iterator_base& rhs) noexcept
+    {
+        return lhs._index > rhs._index;
+    }
+    friend bool operator<=(const iterator_base& lhs, const iterator_base& rhs) noexcept
+    {
+        return lhs._index <= rhs._index;
+    }
+    friend bool operator>=(const iterator_base& lhs, const iterator_base& rhs) noexcept
+    {
+        return lhs._index >= rhs._index;
+    }
+
+private:
+    iterator_base(const key_t* keys, mapped_ptr values, size_type index) noexcept
+        : _keys(keys), _values(values), _index(index)
+    {
+    }
+
+    const key_t* _keys = nullptr;
+    mapped_ptr _values = nullptr;
+    size_type _index = 0;
+};
+} // namespace json
+
+// Entries, whatever their references, have the stored pair as common reference.
+template <typename key_t, typename lhs_ref_t, typename rhs_ref_t, template <typename> typename lhs_qual_t,
+          template <typename> typename rhs_qual_t>
+struct std::basic_common_reference<json::flat_map_entry<key_t, lhs_ref_t>, json::flat_map_entry<key_t, rhs_ref_t>,
+                                   lhs_qual_t, rhs_qual_t>
+{
+    using type = std::pair<const key_t, std::remove_cvref_t<lhs_ref_t>>;
+};
+template <typename key_t, typename mapped_ref_t, typename mapped_t, template <typename> typename lhs_qual_t,
+          template <typename> typename rhs_qual_t>
+struct std::basic_common_reference<json::flat_map_entry<key_t, mapped_ref_t>, std::pair<const key_t, mapped_t>,
+                                   lhs_qual_t, rhs_qual_t>
+{
+    using type = std::pair<const key_t, mapped_t>;
+};
+template <typename key_t, typename mapped_ref_t, typename mapped_t, template <typename> typename lhs_qual_t,
+          template <typename> typename rhs_qual_t>
+struct std::basic_common_reference<std::pair<const key_t, mapped_t>, json::flat_map_entry<key_t, mapped_ref_t>,
+                                   lhs_qual_t, rhs_qual_t>
+{
+    using type = std::pair<const key_t, mapped_t>;
+};
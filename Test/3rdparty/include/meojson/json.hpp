@@ -1,19 +1,31 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <initializer_list>
+#include <iomanip>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
 #include <optional>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <variant>
 #include <vector>
 
 #include "packed_bytes.hpp"
 
+#ifdef MEOJSON_FLAT_OBJECT
+#include "flat_map.hpp"
+#endif
+
 #define MEOJSON_INLINE inline
 
 namespace json
@@ -65,7 +77,9 @@ public:
         object
     };
 
-    using var_t = std::variant<string_t, array_ptr, object_ptr>;
+    // Numbers are kept as text when parsed, so that they are written back exactly as they were read.
+    // Numbers constructed in code are stored natively as long long or double and only formatted on output.
+    using var_t = std::variant<string_t, array_ptr, object_ptr, long long, double>;
     using char_t = typename string_t::value_type;
 
 public:
@@ -165,6 +179,13 @@ public:
     void clear() noexcept;
 
     string_t dumps(std::optional<size_t> indent = std::nullopt) const { return indent ? format(*indent) : to_string(); }
+    // Append the text to `buffer` instead of returning a new string, reusing a buffer across calls
+    // saves the allocations. indent works as in dumps().
+    void dump_to(string_t& buffer, std::optional<size_t> indent = std::nullopt) const;
+    // Write the text to a stream in fixed-size chunks, without building it as a whole first.
+    template <typename ostream_t,
+              typename = std::enable_if_t<std::is_base_of_v<std::basic_ostream<char_t>, ostream_t>>>
+    void dump_to(ostream_t& out, std::optional<size_t> indent = std::nullopt) const;
     // return raw string
     string_t to_string() const;
     string_t format() const { return format(4, 0); }
@@ -219,6 +240,8 @@ private:
     friend class basic_object<string_t>;
 
     string_t format(size_t indent, size_t indent_times) const;
+    template <typename sink_t>
+    void dump_impl(sink_t& sink, std::optional<size_t> indent, size_t indent_times) const;
 
     static var_t deep_copy(const var_t& src);
 
@@ -234,6 +257,12 @@ private:
     const string_t& as_basic_type_str() const;
     string_t& as_basic_type_str();
 
+    template <typename num_t>
+    static var_t number_storage(num_t num);
+    template <typename num_t>
+    num_t as_number() const;
+    string_t number_to_string() const;
+
     value_type _type = value_type::null;
     var_t _raw_data;
 };
@@ -284,6 +313,13 @@ public:
     const basic_value<string_t>& at(size_t pos) const;
 
     string_t dumps(std::optional<size_t> indent = std::nullopt) const { return indent ? format(*indent) : to_string(); }
+    // Append the text to `buffer` instead of returning a new string, reusing a buffer across calls
+    // saves the allocations. indent works as in dumps().
+    void dump_to(string_t& buffer, std::optional<size_t> indent = std::nullopt) const;
+    // Write the text to a stream in fixed-size chunks, without building it as a whole first.
+    template <typename ostream_t,
+              typename = std::enable_if_t<std::is_base_of_v<std::basic_ostream<char_t>, ostream_t>>>
+    void dump_to(ostream_t& out, std::optional<size_t> indent = std::nullopt) const;
     string_t to_string() const;
     string_t format() const { return format(4, 0); }
     template <typename sz_t, typename = std::enable_if_t<std::is_integral_v<sz_t> && !std::is_same_v<sz_t, bool>>>
@@ -349,6 +385,8 @@ private:
     auto get_helper(const value_t& default_value, size_t pos) const;
 
     string_t format(size_t indent, size_t indent_times) const;
+    template <typename sink_t>
+    void dump_impl(sink_t& sink, std::optional<size_t> indent, size_t indent_times) const;
 
 private:
     raw_array _array_data;
@@ -365,7 +403,15 @@ class basic_object
     friend class basic_array<string_t>;
 
 public:
+    // Define MEOJSON_FLAT_OBJECT to store members in a sorted vector instead of a tree.
+    // Lookups become a binary search over contiguous memory, at the cost of O(n) insertion
+    // and of references to members being invalidated by later insertions. Iterators yield
+    // pairs of references, to be bound with `const auto&` or `auto&&` rather than `auto&`.
+#ifdef MEOJSON_FLAT_OBJECT
+    using raw_object = flat_map<string_t, basic_value<string_t>>;
+#else
     using raw_object = std::map<string_t, basic_value<string_t>>;
+#endif
     using key_type = typename raw_object::key_type;
     using mapped_type = typename raw_object::mapped_type;
     using value_type = typename raw_object::value_type;
@@ -398,6 +444,13 @@ public:
     const basic_value<string_t>& at(const string_t& key) const;
 
     string_t dumps(std::optional<size_t> indent = std::nullopt) const { return indent ? format(*indent) : to_string(); }
+    // Append the text to `buffer` instead of returning a new string, reusing a buffer across calls
+    // saves the allocations. indent works as in dumps().
+    void dump_to(string_t& buffer, std::optional<size_t> indent = std::nullopt) const;
+    // Write the text to a stream in fixed-size chunks, without building it as a whole first.
+    template <typename ostream_t,
+              typename = std::enable_if_t<std::is_base_of_v<std::basic_ostream<char_t>, ostream_t>>>
+    void dump_to(ostream_t& out, std::optional<size_t> indent = std::nullopt) const;
     string_t to_string() const;
     string_t format() const { return format(4, 0); }
     template <typename sz_t, typename = std::enable_if_t<std::is_integral_v<sz_t> && !std::is_same_v<sz_t, bool>>>
@@ -456,6 +509,8 @@ private:
     auto get_helper(const value_t& default_value, const string_t& key) const;
 
     string_t format(size_t indent, size_t indent_times) const;
+    template <typename sink_t>
+    void dump_impl(sink_t& sink, std::optional<size_t> indent, size_t indent_times) const;
 
 private:
     raw_object _object_data;
@@ -568,6 +623,280 @@ const basic_value<string_t> invalid_value();
 template <bool loose, typename any_t, typename string_t = default_string_t>
 basic_value<string_t> serialize(any_t&& arg);
 
+// ********************************
+// *      number helper impl      *
+// ********************************
+
+namespace _number_helper
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // floating point <charconv> is only complete in recent standard libraries
+    inline constexpr bool has_floating_charconv = true;
+#else
+    inline constexpr bool has_floating_charconv = false;
+#endif
+
+    // Convert the text of a number token. Like std::sto*, it reads the longest valid prefix,
+    // but it neither allocates nor depends on the C locale.
+    template <typename num_t, typename char_t>
+    MEOJSON_INLINE num_t from_chars(std::basic_string_view<char_t> text)
+    {
+        if constexpr (!std::is_same_v<char_t, char>) {
+            // number tokens are pure ASCII
+            std::string narrow(text.size(), '\0');
+            for (size_t i = 0; i < text.size(); ++i) {
+                narrow[i] = static_cast<char>(text[i]);
+            }
+            return from_chars<num_t, char>(narrow);
+        }
+        else if constexpr (std::is_floating_point_v<num_t> && !has_floating_charconv) {
+            std::string str(text);
+            if constexpr (std::is_same_v<num_t, float>) {
+                return std::stof(str);
+            }
+            else if constexpr (std::is_same_v<num_t, double>) {
+                return std::stod(str);
+            }
+            else {
+                return std::stold(str);
+            }
+        }
+        else {
+            num_t result {};
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), result);
+            if (ec == std::errc::result_out_of_range) {
+                throw exception("Number out of range");
+            }
+            else if (ec != std::errc {}) {
+                throw exception("Unknown Parse Error");
+            }
+            return result;
+        }
+    }
+
+    // Integers are printed exactly, floating point numbers with the shortest text that reads back to the same
+    // value, e.g. 0.1 instead of 0.100000.
+    // 64 chars are enough for any integer and for the shortest form of any floating point number.
+    constexpr size_t max_chars = 64;
+
+    template <typename num_t>
+    MEOJSON_INLINE char* to_chars(char* first, char* last, num_t num)
+    {
+        if constexpr (std::is_floating_point_v<num_t> && !has_floating_charconv) {
+            std::ostringstream ss;
+            ss.imbue(std::locale::classic());
+            ss << std::setprecision(std::numeric_limits<num_t>::max_digits10) << num;
+            auto str = std::move(ss).str();
+            if (str.size() > static_cast<size_t>(last - first)) {
+                throw exception("Unknown Format Error");
+            }
+            return std::copy(str.begin(), str.end(), first);
+        }
+        else {
+            auto [ptr, ec] = std::to_chars(first, last, num);
+            if (ec != std::errc {}) {
+                throw exception("Unknown Format Error");
+            }
+            return ptr;
+        }
+    }
+
+    template <typename string_t, typename num_t>
+    MEOJSON_INLINE string_t to_chars(num_t num)
+    {
+        char buf[max_chars];
+        return string_t(buf, to_chars(buf, buf + max_chars, num));
+    }
+
+    // Convert a natively stored number, truncating floating point values toward zero like reading
+    // the integer prefix of their text does.
+    template <typename to_t, typename from_t>
+    MEOJSON_INLINE to_t numeric_cast(from_t num)
+    {
+        if constexpr (std::is_floating_point_v<to_t>) {
+            return static_cast<to_t>(num);
+        }
+        else if constexpr (std::is_floating_point_v<from_t>) {
+            // both bounds are powers of two, hence exact as floating point numbers
+            constexpr auto lower = static_cast<from_t>(std::numeric_limits<to_t>::min());
+            constexpr auto upper = static_cast<from_t>(std::numeric_limits<to_t>::max() / 2 + 1) * 2;
+            const from_t truncated = std::trunc(num);
+            if (!(truncated >= lower && truncated < upper)) {
+                throw exception("Number out of range");
+            }
+            return static_cast<to_t>(truncated);
+        }
+        else {
+            if constexpr (std::is_signed_v<to_t>) {
+                if (num < static_cast<from_t>(std::numeric_limits<to_t>::min()) ||
+                    num > static_cast<from_t>(std::numeric_limits<to_t>::max())) {
+                    throw exception("Number out of range");
+                }
+            }
+            else {
+                if (num < 0 || static_cast<unsigned long long>(num) > std::numeric_limits<to_t>::max()) {
+                    throw exception("Number out of range");
+                }
+            }
+            return static_cast<to_t>(num);
+        }
+    }
+}
+
+// ******************************
+// *      dump helper impl      *
+// ******************************
+
+namespace _dump_helper
+{
+    // Appends to a caller-owned string, whose capacity is kept between dumps.
+    template <typename string_t>
+    class string_sink
+    {
+    public:
+        using char_t = typename string_t::value_type;
+
+        explicit string_sink(string_t& str) : _str(str) {}
+
+        void put(char_t ch) { _str.push_back(ch); }
+        void fill(char_t ch, size_t count) { _str.append(count, ch); }
+        template <typename in_char_t>
+        void write(const in_char_t* str, size_t len)
+        {
+            if constexpr (std::is_same_v<in_char_t, char_t>) {
+                _str.append(str, len);
+            }
+            else {
+                // only used for number text, which is ASCII
+                _str.append(str, str + len);
+            }
+        }
+        void flush() noexcept {}
+
+    private:
+        string_t& _str;
+    };
+
+    // Collects the output in a fixed buffer and hands it to the stream chunk by chunk.
+    template <typename ostream_t>
+    class stream_sink
+    {
+    public:
+        using char_t = typename ostream_t::char_type;
+
+        explicit stream_sink(ostream_t& out) : _out(out) {}
+        stream_sink(const stream_sink&) = delete;
+        stream_sink& operator=(const stream_sink&) = delete;
+
+        void put(char_t ch)
+        {
+            if (_size == buffer_size) {
+                flush();
+            }
+            _buffer[_size++] = ch;
+        }
+        void fill(char_t ch, size_t count)
+        {
+            while (count > 0) {
+                if (_size == buffer_size) {
+                    flush();
+                }
+                size_t len = (std::min)(count, buffer_size - _size);
+                std::fill_n(_buffer + _size, len, ch);
+                _size += len;
+                count -= len;
+            }
+        }
+        template <typename in_char_t>
+        void write(const in_char_t* str, size_t len)
+        {
+            if (len > buffer_size - _size) {
+                flush();
+                if constexpr (std::is_same_v<in_char_t, char_t>) {
+                    if (len >= buffer_size) {
+                        _out.write(str, static_cast<std::streamsize>(len));
+                        return;
+                    }
+                }
+            }
+            for (size_t pos = 0; pos < len;) {
+                if (_size == buffer_size) {
+                    flush();
+                }
+                size_t step = (std::min)(len - pos, buffer_size - _size);
+                std::copy_n(str + pos, step, _buffer + _size);
+                _size += step;
+                pos += step;
+            }
+        }
+        void flush()
+        {
+            _out.write(_buffer, static_cast<std::streamsize>(_size));
+            _size = 0;
+        }
+
+    private:
+        static constexpr size_t buffer_size = 4096 / sizeof(char_t);
+
+        ostream_t& _out;
+        char_t _buffer[buffer_size];
+        size_t _size = 0;
+    };
+
+    // Write a quoted string, escaping the same characters as unescape_string.
+    template <typename sink_t, typename string_t>
+    MEOJSON_INLINE void write_string(sink_t& sink, const string_t& str)
+    {
+        using char_t = typename string_t::value_type;
+
+        sink.put(char_t('"'));
+        const char_t* data = str.data();
+        size_t no_escape_beg = 0;
+        for (size_t pos = 0; pos < str.size(); ++pos) {
+            char_t escape = 0;
+            switch (data[pos]) {
+            case '"':
+                escape = '"';
+                break;
+            case '\\':
+                escape = '\\';
+                break;
+            case '\b':
+                escape = 'b';
+                break;
+            case '\f':
+                escape = 'f';
+                break;
+            case '\n':
+                escape = 'n';
+                break;
+            case '\r':
+                escape = 'r';
+                break;
+            case '\t':
+                escape = 't';
+                break;
+            default:
+                continue;
+            }
+            sink.write(data + no_escape_beg, pos - no_escape_beg);
+            sink.put(char_t('\\'));
+            sink.put(escape);
+            no_escape_beg = pos + 1;
+        }
+        sink.write(data + no_escape_beg, str.size() - no_escape_beg);
+        sink.put(char_t('"'));
+    }
+
+    template <typename sink_t, typename num_t>
+    MEOJSON_INLINE void write_number(sink_t& sink, num_t num)
+    {
+        char buf[_number_helper::max_chars];
+        char* end = _number_helper::to_chars(buf, buf + _number_helper::max_chars, num);
+        sink.write(buf, static_cast<size_t>(end - buf));
+    }
+}
+
 // ******************************
 // *      basic_value impl      *
 // ******************************
@@ -614,61 +943,61 @@ MEOJSON_INLINE basic_value<string_t>::basic_value(bool b)
 }
 
 template <typename string_t>
-MEOJSON_INLINE basic_value<string_t>::basic_value(int num) : _type(value_type::number), _raw_data(std::to_string(num))
+MEOJSON_INLINE basic_value<string_t>::basic_value(int num) : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
 MEOJSON_INLINE basic_value<string_t>::basic_value(unsigned num)
-    : _type(value_type::number), _raw_data(std::to_string(num))
+    : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
-MEOJSON_INLINE basic_value<string_t>::basic_value(long num) : _type(value_type::number), _raw_data(std::to_string(num))
+MEOJSON_INLINE basic_value<string_t>::basic_value(long num) : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
 MEOJSON_INLINE basic_value<string_t>::basic_value(unsigned long num)
-    : _type(value_type::number), _raw_data(std::to_string(num))
+    : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
 MEOJSON_INLINE basic_value<string_t>::basic_value(long long num)
-    : _type(value_type::number), _raw_data(std::to_string(num))
+    : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
 MEOJSON_INLINE basic_value<string_t>::basic_value(unsigned long long num)
-    : _type(value_type::number), _raw_data(std::to_string(num))
+    : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
-MEOJSON_INLINE basic_value<string_t>::basic_value(float num) : _type(value_type::number), _raw_data(std::to_string(num))
+MEOJSON_INLINE basic_value<string_t>::basic_value(float num) : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
 MEOJSON_INLINE basic_value<string_t>::basic_value(double num)
-    : _type(value_type::number), _raw_data(std::to_string(num))
+    : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
 
 template <typename string_t>
 MEOJSON_INLINE basic_value<string_t>::basic_value(long double num)
-    : _type(value_type::number), _raw_data(std::to_string(num))
+    : _type(value_type::number), _raw_data(number_storage(num))
 {
     ;
 }
@@ -900,96 +1229,55 @@ MEOJSON_INLINE bool basic_value<string_t>::as_boolean() const
 template <typename string_t>
 MEOJSON_INLINE int basic_value<string_t>::as_integer() const
 {
-    if (is_number()) {
-        return std::stoi(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<int>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE unsigned basic_value<string_t>::as_unsigned() const
 {
-    // I don't know why there is no std::stou.
-    return static_cast<unsigned>(as_unsigned_long());
+    return as_number<unsigned>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE long basic_value<string_t>::as_long() const
 {
-    if (is_number()) {
-        return std::stol(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<long>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE unsigned long basic_value<string_t>::as_unsigned_long() const
 {
-    if (is_number()) {
-        return std::stoul(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<unsigned long>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE long long basic_value<string_t>::as_long_long() const
 {
-    if (is_number()) {
-        return std::stoll(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<long long>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE unsigned long long basic_value<string_t>::as_unsigned_long_long() const
 {
-    if (is_number()) {
-        return std::stoull(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<unsigned long long>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE float basic_value<string_t>::as_float() const
 {
-    if (is_number()) {
-        return std::stof(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<float>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE double basic_value<string_t>::as_double() const
 {
-    if (is_number()) {
-        return std::stod(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<double>();
 }
 
 template <typename string_t>
 MEOJSON_INLINE long double basic_value<string_t>::as_long_double() const
 {
-    if (is_number()) {
-        return std::stold(as_basic_type_str());
-    }
-    else {
-        throw exception("Wrong Type");
-    }
+    return as_number<long double>();
 }
 
 template <typename string_t>
@@ -1110,36 +1398,70 @@ MEOJSON_INLINE void basic_value<string_t>::clear() noexcept
 template <typename string_t>
 MEOJSON_INLINE string_t basic_value<string_t>::to_string() const
 {
-    switch (_type) {
-    case value_type::null:
-        return null_string<string_t>();
-    case value_type::boolean:
-    case value_type::number:
-        return as_basic_type_str();
-    case value_type::string:
-        return char_t('"') + unescape_string(as_basic_type_str()) + char_t('"');
-    case value_type::array:
-        return as_array().to_string();
-    case value_type::object:
-        return as_object().to_string();
-    default:
-        throw exception("Unknown basic_value Type");
-    }
+    string_t str;
+    dump_to(str);
+    return str;
 }
 
 template <typename string_t>
 MEOJSON_INLINE string_t basic_value<string_t>::format(size_t indent, size_t indent_times) const
+{
+    string_t str;
+    _dump_helper::string_sink<string_t> sink(str);
+    dump_impl(sink, indent, indent_times);
+    return str;
+}
+
+template <typename string_t>
+MEOJSON_INLINE void basic_value<string_t>::dump_to(string_t& buffer, std::optional<size_t> indent) const
+{
+    _dump_helper::string_sink<string_t> sink(buffer);
+    dump_impl(sink, indent, 0);
+}
+
+template <typename string_t>
+template <typename ostream_t, typename>
+MEOJSON_INLINE void basic_value<string_t>::dump_to(ostream_t& out, std::optional<size_t> indent) const
+{
+    _dump_helper::stream_sink<ostream_t> sink(out);
+    dump_impl(sink, indent, 0);
+    sink.flush();
+}
+
+template <typename string_t>
+template <typename sink_t>
+MEOJSON_INLINE void basic_value<string_t>::dump_impl(sink_t& sink, std::optional<size_t> indent,
+                                                     size_t indent_times) const
 {
     switch (_type) {
-    case value_type::null:
+    case value_type::null: {
+        constexpr char_t null_chars[] = { 'n', 'u', 'l', 'l' };
+        sink.write(null_chars, std::size(null_chars));
+        break;
+    }
     case value_type::boolean:
+        sink.write(as_basic_type_str().data(), as_basic_type_str().size());
+        break;
     case value_type::number:
+        if (const auto integer_ptr = std::get_if<long long>(&_raw_data)) {
+            _dump_helper::write_number(sink, *integer_ptr);
+        }
+        else if (const auto floating_ptr = std::get_if<double>(&_raw_data)) {
+            _dump_helper::write_number(sink, *floating_ptr);
+        }
+        else {
+            sink.write(as_basic_type_str().data(), as_basic_type_str().size());
+        }
+        break;
     case value_type::string:
-        return to_string();
+        _dump_helper::write_string(sink, as_basic_type_str());
+        break;
     case value_type::array:
-        return as_array().format(indent, indent_times);
+        as_array().dump_impl(sink, indent, indent_times);
+        break;
     case value_type::object:
-        return as_object().format(indent, indent_times);
+        as_object().dump_impl(sink, indent, indent_times);
+        break;
     default:
         throw exception("Unknown basic_value Type");
     }
@@ -1165,8 +1487,13 @@ MEOJSON_INLINE bool basic_value<string_t>::operator==(const basic_value<string_t
     switch (_type) {
     case value_type::null:
         return rhs.is_null();
-    case value_type::boolean:
     case value_type::number:
+        // a parsed number and a constructed one are equal when they print the same
+        if (_raw_data.index() != rhs._raw_data.index()) {
+            return number_to_string() == rhs.number_to_string();
+        }
+        return _raw_data == rhs._raw_data;
+    case value_type::boolean:
     case value_type::string:
         return _raw_data == rhs._raw_data;
     case value_type::array:
@@ -1311,6 +1638,12 @@ MEOJSON_INLINE typename basic_value<string_t>::var_t basic_value<string_t>::deep
     else if (const auto obj_ptr = std::get_if<object_ptr>(&src)) {
         dst = std::make_unique<basic_object<string_t>>(**obj_ptr);
     }
+    else if (const auto integer_ptr = std::get_if<long long>(&src)) {
+        dst = *integer_ptr;
+    }
+    else if (const auto floating_ptr = std::get_if<double>(&src)) {
+        dst = *floating_ptr;
+    }
     else {
         // maybe invalid_value
     }
@@ -1318,6 +1651,56 @@ MEOJSON_INLINE typename basic_value<string_t>::var_t basic_value<string_t>::deep
     return dst;
 }
 
+template <typename string_t>
+template <typename num_t>
+MEOJSON_INLINE typename basic_value<string_t>::var_t basic_value<string_t>::number_storage(num_t num)
+{
+    if constexpr (std::is_integral_v<num_t> && std::is_signed_v<num_t>) {
+        return static_cast<long long>(num);
+    }
+    else if constexpr (std::is_integral_v<num_t>) {
+        if (num <= static_cast<unsigned long long>(std::numeric_limits<long long>::max())) {
+            return static_cast<long long>(num);
+        }
+        return _number_helper::to_chars<string_t>(num);
+    }
+    else if constexpr (std::is_same_v<num_t, double>) {
+        return num;
+    }
+    else {
+        // float and long double keep their own shortest form, a double would print differently
+        return _number_helper::to_chars<string_t>(num);
+    }
+}
+
+template <typename string_t>
+template <typename num_t>
+MEOJSON_INLINE num_t basic_value<string_t>::as_number() const
+{
+    if (!is_number()) {
+        throw exception("Wrong Type");
+    }
+    if (const auto integer_ptr = std::get_if<long long>(&_raw_data)) {
+        return _number_helper::numeric_cast<num_t>(*integer_ptr);
+    }
+    else if (const auto floating_ptr = std::get_if<double>(&_raw_data)) {
+        return _number_helper::numeric_cast<num_t>(*floating_ptr);
+    }
+    return _number_helper::from_chars<num_t, char_t>(as_basic_type_str());
+}
+
+template <typename string_t>
+MEOJSON_INLINE string_t basic_value<string_t>::number_to_string() const
+{
+    if (const auto integer_ptr = std::get_if<long long>(&_raw_data)) {
+        return _number_helper::to_chars<string_t>(*integer_ptr);
+    }
+    else if (const auto floating_ptr = std::get_if<double>(&_raw_data)) {
+        return _number_helper::to_chars<string_t>(*floating_ptr);
+    }
+    return as_basic_type_str();
+}
+
 // ******************************
 // *      basic_array impl      *
 // ******************************
@@ -1403,33 +1786,61 @@ MEOJSON_INLINE const basic_value<string_t>& basic_array<string_t>::at(size_t pos
 template <typename string_t>
 MEOJSON_INLINE string_t basic_array<string_t>::to_string() const
 {
-    string_t str { '[' };
-    for (auto iter = _array_data.cbegin(); iter != _array_data.cend();) {
-        str += iter->to_string();
-        if (++iter != _array_data.cend()) {
-            str += ',';
-        }
-    }
-    str += char_t(']');
+    string_t str;
+    dump_to(str);
     return str;
 }
 
 template <typename string_t>
 MEOJSON_INLINE string_t basic_array<string_t>::format(size_t indent, size_t indent_times) const
 {
-    const string_t tail_indent(indent * indent_times, ' ');
-    const string_t body_indent(indent * (indent_times + 1), ' ');
+    string_t str;
+    _dump_helper::string_sink<string_t> sink(str);
+    dump_impl(sink, indent, indent_times);
+    return str;
+}
+
+template <typename string_t>
+MEOJSON_INLINE void basic_array<string_t>::dump_to(string_t& buffer, std::optional<size_t> indent) const
+{
+    _dump_helper::string_sink<string_t> sink(buffer);
+    dump_impl(sink, indent, 0);
+}
 
-    string_t str { '[', '\n' };
+template <typename string_t>
+template <typename ostream_t, typename>
+MEOJSON_INLINE void basic_array<string_t>::dump_to(ostream_t& out, std::optional<size_t> indent) const
+{
+    _dump_helper::stream_sink<ostream_t> sink(out);
+    dump_impl(sink, indent, 0);
+    sink.flush();
+}
+
+template <typename string_t>
+template <typename sink_t>
+MEOJSON_INLINE void basic_array<string_t>::dump_impl(sink_t& sink, std::optional<size_t> indent,
+                                                   size_t indent_times) const
+{
+    sink.put(char_t('['));
+    if (indent) {
+        sink.put(char_t('\n'));
+    }
     for (auto iter = _array_data.cbegin(); iter != _array_data.cend();) {
-        str += body_indent + iter->format(indent, indent_times + 1);
+        if (indent) {
+            sink.fill(char_t(' '), *indent * (indent_times + 1));
+        }
+        iter->dump_impl(sink, indent, indent_times + 1);
         if (++iter != _array_data.cend()) {
-            str += ',';
+            sink.put(char_t(','));
+        }
+        if (indent) {
+            sink.put(char_t('\n'));
         }
-        str += '\n';
     }
-    str += tail_indent + char_t(']');
-    return str;
+    if (indent) {
+        sink.fill(char_t(' '), *indent * indent_times);
+    }
+    sink.put(char_t(']'));
 }
 
 template <typename string_t>
@@ -1726,36 +2137,67 @@ MEOJSON_INLINE decltype(auto) basic_object<string_t>::insert(args_t&&... args)
 template <typename string_t>
 MEOJSON_INLINE string_t basic_object<string_t>::to_string() const
 {
-    string_t str { '{' };
-    for (auto iter = _object_data.cbegin(); iter != _object_data.cend();) {
-        const auto& [key, val] = *iter;
-        str += char_t('"') + unescape_string(key) + string_t { '\"', ':' } + val.to_string();
-        if (++iter != _object_data.cend()) {
-            str += ',';
-        }
-    }
-    str += char_t('}');
+    string_t str;
+    dump_to(str);
     return str;
 }
 
 template <typename string_t>
 MEOJSON_INLINE string_t basic_object<string_t>::format(size_t indent, size_t indent_times) const
 {
-    const string_t tail_indent(indent * indent_times, ' ');
-    const string_t body_indent(indent * (indent_times + 1), ' ');
+    string_t str;
+    _dump_helper::string_sink<string_t> sink(str);
+    dump_impl(sink, indent, indent_times);
+    return str;
+}
 
-    string_t str { '{', '\n' };
+template <typename string_t>
+MEOJSON_INLINE void basic_object<string_t>::dump_to(string_t& buffer, std::optional<size_t> indent) const
+{
+    _dump_helper::string_sink<string_t> sink(buffer);
+    dump_impl(sink, indent, 0);
+}
+
+template <typename string_t>
+template <typename ostream_t, typename>
+MEOJSON_INLINE void basic_object<string_t>::dump_to(ostream_t& out, std::optional<size_t> indent) const
+{
+    _dump_helper::stream_sink<ostream_t> sink(out);
+    dump_impl(sink, indent, 0);
+    sink.flush();
+}
+
+template <typename string_t>
+template <typename sink_t>
+MEOJSON_INLINE void basic_object<string_t>::dump_impl(sink_t& sink, std::optional<size_t> indent,
+                                                    size_t indent_times) const
+{
+    sink.put(char_t('{'));
+    if (indent) {
+        sink.put(char_t('\n'));
+    }
     for (auto iter = _object_data.cbegin(); iter != _object_data.cend();) {
         const auto& [key, val] = *iter;
-        str += body_indent + char_t('"') + unescape_string(key) + string_t { '\"', ':', ' ' } +
-               val.format(indent, indent_times + 1);
+        if (indent) {
+            sink.fill(char_t(' '), *indent * (indent_times + 1));
+        }
+        _dump_helper::write_string(sink, key);
+        sink.put(char_t(':'));
+        if (indent) {
+            sink.put(char_t(' '));
+        }
+        val.dump_impl(sink, indent, indent_times + 1);
         if (++iter != _object_data.cend()) {
-            str += ',';
+            sink.put(char_t(','));
+        }
+        if (indent) {
+            sink.put(char_t('\n'));
         }
-        str += '\n';
     }
-    str += tail_indent + char_t('}');
-    return str;
+    if (indent) {
+        sink.fill(char_t(' '), *indent * indent_times);
+    }
+    sink.put(char_t('}'));
 }
 
 template <typename string_t>
@@ -1935,6 +2377,226 @@ MEOJSON_INLINE bool basic_object<string_t>::operator==(const basic_object<string
 // *      parser impl      *
 // *************************
 
+namespace _parser_helper
+{
+    // Advance `cur` to the first character inside a string literal that is a control character,
+    // a quote or a backslash, scanning accel_traits::step bytes at a time.
+    // Stops early (leaving the tail to the caller) when fewer than step bytes remain.
+    template <typename accel_traits, typename iter_t>
+    MEOJSON_INLINE void skip_string_literal(iter_t& cur, const iter_t& end)
+    {
+        if constexpr (sizeof(*cur) != 1) {
+            return;
+        }
+        else if constexpr (packed_bytes_is_runtime_dispatch<accel_traits>) {
+            if (end - cur >= accel_traits::step) {
+                cur += accel_traits::skip_string_literal(reinterpret_cast<const char*>(&(*cur)),
+                                                         static_cast<size_t>(end - cur));
+            }
+        }
+        else {
+            while (end - cur >= accel_traits::step) {
+                auto pack = accel_traits::load_unaligned(&(*cur));
+                auto result = accel_traits::less(pack, 32);
+                result = accel_traits::bitwise_or(result, accel_traits::equal(pack, static_cast<uint8_t>('"')));
+                result = accel_traits::bitwise_or(result, accel_traits::equal(pack, static_cast<uint8_t>('\\')));
+                if (accel_traits::is_all_zero(result)) {
+                    cur += accel_traits::step;
+                }
+                else {
+                    auto index = accel_traits::first_nonzero_byte(result);
+                    cur += index;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Scan the body of a string literal, `cur` pointing just past the opening quote.
+    // On success `cur` points at the closing quote and `escaped` tells whether the body
+    // contains backslash escapes. Nothing is copied.
+    template <typename accel_traits, typename iter_t>
+    MEOJSON_INLINE bool scan_string_literal(iter_t& cur, const iter_t& end, bool& escaped)
+    {
+        escaped = false;
+        while (cur != end) {
+            if constexpr (sizeof(*cur) == 1 && accel_traits::available) {
+                skip_string_literal<accel_traits>(cur, end);
+                if (cur == end) {
+                    break;
+                }
+            }
+            switch (*cur) {
+            case '\t':
+            case '\r':
+            case '\n':
+                return false;
+            case '\\':
+                if (++cur == end) {
+                    return false;
+                }
+                switch (*cur) {
+                case '"':
+                case '\\':
+                case '/':
+                case 'b':
+                case 'f':
+                case 'n':
+                case 'r':
+                case 't':
+                    break;
+                default:
+                    // Illegal backslash escape
+                    return false;
+                }
+                escaped = true;
+                ++cur;
+                break;
+            case '"':
+                return true;
+            default:
+                ++cur;
+                break;
+            }
+        }
+        return false;
+    }
+
+    // Append the decoded form of a string literal body validated by scan_string_literal.
+    template <typename string_t, typename string_view_t>
+    MEOJSON_INLINE void decode_string_literal(string_view_t raw, string_t& result)
+    {
+        result.reserve(result.size() + raw.size());
+        for (auto cur = raw.begin(); cur != raw.end(); ++cur) {
+            if (*cur != '\\' || cur + 1 == raw.end()) {
+                result.push_back(*cur);
+                continue;
+            }
+            switch (*++cur) {
+            case 'b':
+                result.push_back('\b');
+                break;
+            case 'f':
+                result.push_back('\f');
+                break;
+            case 'n':
+                result.push_back('\n');
+                break;
+            case 'r':
+                result.push_back('\r');
+                break;
+            case 't':
+                result.push_back('\t');
+                break;
+            default: // '"', '\\', '/'
+                result.push_back(*cur);
+                break;
+            }
+        }
+    }
+
+    template <typename char_t>
+    MEOJSON_INLINE bool is_digit(char_t ch) noexcept
+    {
+        return ch >= '0' && ch <= '9';
+    }
+
+    // Advance past a run of digits, testing eight bytes at a time on narrow strings.
+    template <typename iter_t>
+    MEOJSON_INLINE void skip_digits(iter_t& cur, const iter_t& end) noexcept
+    {
+        if constexpr (sizeof(*cur) == 1) {
+            while (end - cur >= 8) {
+                uint64_t chunk = 0;
+                std::memcpy(&chunk, &(*cur), sizeof(chunk));
+                // a byte is a digit iff its high nibble is 3 and stays 3 after adding 6
+                if (((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) !=
+                    0x3333333333333333) {
+                    break;
+                }
+                cur += 8;
+            }
+        }
+        while (cur != end && is_digit(*cur)) {
+            ++cur;
+        }
+    }
+
+    // Scan a number token with the same grammar as parser::parse_number.
+    // Like the parser, a number may not end the input: the root is always an array or object.
+    template <typename iter_t>
+    MEOJSON_INLINE bool scan_number(iter_t& cur, const iter_t& end)
+    {
+        auto skip_digit = [&]() {
+            // At least one digit
+            if (cur == end || !is_digit(*cur)) {
+                return false;
+            }
+            skip_digits(cur, end);
+            return cur != end;
+        };
+
+        if (*cur == '-') {
+            ++cur;
+        }
+        // numbers cannot have leading zeroes
+        if (cur != end && *cur == '0' && cur + 1 != end && is_digit(*(cur + 1))) {
+            return false;
+        }
+        if (!skip_digit()) {
+            return false;
+        }
+        if (*cur == '.') {
+            ++cur;
+            if (!skip_digit()) {
+                return false;
+            }
+        }
+        if (*cur == 'e' || *cur == 'E') {
+            if (++cur == end) {
+                return false;
+            }
+            if (*cur == '+' || *cur == '-') {
+                ++cur;
+            }
+            if (!skip_digit()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns false at the end of input or at a NUL.
+    template <typename accel_traits, typename iter_t>
+    MEOJSON_INLINE bool skip_whitespace(iter_t& cur, const iter_t& end) noexcept
+    {
+        if constexpr (sizeof(*cur) == 1 && packed_bytes_is_runtime_dispatch<accel_traits>) {
+            // most values are separated by at most one space, only hand long runs such as
+            // indentation, after an LF or a CRLF, over to the vector scanner
+            if (end - cur > accel_traits::step && (*cur == ' ' || *cur == '\n' || *cur == '\r') &&
+                (cur[1] == ' ' || cur[1] == '\t' || cur[1] == '\n')) {
+                cur += accel_traits::skip_whitespace(reinterpret_cast<const char*>(&(*cur)),
+                                                     static_cast<size_t>(end - cur));
+            }
+        }
+        while (cur != end) {
+            switch (*cur) {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                ++cur;
+                break;
+            case '\0':
+                return false;
+            default:
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
 template <typename string_t, typename parsing_t, typename accel_traits>
 MEOJSON_INLINE std::optional<basic_value<string_t>> parser<string_t, parsing_t, accel_traits>::parse(
     const parsing_t& content)
@@ -2059,7 +2721,7 @@ MEOJSON_INLINE basic_value<string_t> parser<string_t, parsing_t, accel_traits>::
     }
 
     // numbers cannot have leading zeroes
-    if (_cur != _end && *_cur == '0' && _cur + 1 != _end && std::isdigit(*(_cur + 1))) {
+    if (_cur != _end && *_cur == '0' && _cur + 1 != _end && _parser_helper::is_digit(*(_cur + 1))) {
         return invalid_value<string_t>();
     }
 
@@ -2293,59 +2955,27 @@ MEOJSON_INLINE std::optional<string_t> parser<string_t, parsing_t, accel_traits>
 template <typename string_t, typename parsing_t, typename accel_traits>
 MEOJSON_INLINE void parser<string_t, parsing_t, accel_traits>::skip_string_literal()
 {
-    if constexpr (sizeof(*_cur) != 1) {
-        return;
-    }
-    while (_end - _cur >= accel_traits::step) {
-        auto pack = accel_traits::load_unaligned(&(*_cur));
-        auto result = accel_traits::less(pack, 32);
-        result = accel_traits::bitwise_or(result, accel_traits::equal(pack, static_cast<uint8_t>('"')));
-        result = accel_traits::bitwise_or(result, accel_traits::equal(pack, static_cast<uint8_t>('\\')));
-        if (accel_traits::is_all_zero(result)) {
-            _cur += accel_traits::step;
-        }
-        else {
-            auto index = accel_traits::first_nonzero_byte(result);
-            _cur += index;
-            break;
-        }
-    }
+    _parser_helper::skip_string_literal<accel_traits>(_cur, _end);
 }
 
 template <typename string_t, typename parsing_t, typename accel_traits>
 MEOJSON_INLINE bool parser<string_t, parsing_t, accel_traits>::skip_whitespace() noexcept
 {
-    while (_cur != _end) {
-        switch (*_cur) {
-        case ' ':
-        case '\t':
-        case '\r':
-        case '\n':
-            ++_cur;
-            break;
-        case '\0':
-            return false;
-        default:
-            return true;
-        }
-    }
-    return false;
+    return _parser_helper::skip_whitespace<accel_traits>(_cur, _end);
 }
 
 template <typename string_t, typename parsing_t, typename accel_traits>
 MEOJSON_INLINE bool parser<string_t, parsing_t, accel_traits>::skip_digit()
 {
     // At least one digit
-    if (_cur != _end && std::isdigit(*_cur)) {
+    if (_cur != _end && _parser_helper::is_digit(*_cur)) {
         ++_cur;
     }
     else {
         return false;
     }
 
-    while (_cur != _end && std::isdigit(*_cur)) {
-        ++_cur;
-    }
+    _parser_helper::skip_digits(_cur, _end);
 
     if (_cur != _end) {
         return true;
@@ -2417,7 +3047,7 @@ template <typename ostream_t, typename string_t,
                                                         std::is_base_of_v<std_ostream_t, ostream_t>>>
 ostream_t& operator<<(ostream_t& out, const basic_value<string_t>& val)
 {
-    out << val.format();
+    val.dump_to(out, 4);
     return out;
 }
 template <typename ostream_t, typename string_t,
@@ -2427,7 +3057,7 @@ template <typename ostream_t, typename string_t,
               std::enable_if_t<std::is_same_v<std_ostream_t, ostream_t> || std::is_base_of_v<std_ostream_t, ostream_t>>>
 ostream_t& operator<<(ostream_t& out, const basic_array<string_t>& arr)
 {
-    out << arr.format();
+    arr.dump_to(out, 4);
     return out;
 }
 template <typename ostream_t, typename string_t,
@@ -2437,7 +3067,7 @@ template <typename ostream_t, typename string_t,
               std::enable_if_t<std::is_same_v<std_ostream_t, ostream_t> || std::is_base_of_v<std_ostream_t, ostream_t>>>
 ostream_t& operator<<(ostream_t& out, const basic_object<string_t>& obj)
 {
-    out << obj.format();
+    obj.dump_to(out, 4);
     return out;
 }
 
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.hpp"
+
+namespace json
+{
+template <typename char_t, typename accel_traits>
+class basic_reader;
+template <typename char_t>
+struct basic_sax_handler;
+
+using reader = basic_reader<char, packed_bytes_trait_max>;
+using wreader = basic_reader<wchar_t, packed_bytes_trait_max>;
+using sax_handler = basic_sax_handler<char>;
+using wsax_handler = basic_sax_handler<wchar_t>;
+
+enum class token_type : char
+{
+    none,
+    begin_object,
+    end_object,
+    begin_array,
+    end_array,
+    key,
+    string,
+    number,
+    boolean,
+    null,
+    end_of_input,
+    error
+};
+
+// ****************************
+// *      reader declare      *
+// ****************************
+
+// Pull parser: each next() validates and returns one token without building any tree.
+// Strings, keys and numbers are exposed as string_views into the input, which must outlive the reader.
+//
+// Usage:
+//   json::reader r(content);
+//   while (r.next() != json::token_type::end_of_input) { ... }
+template <typename char_t, typename accel_traits = packed_bytes_trait_max>
+class basic_reader
+{
+public:
+    using string_t = std::basic_string<char_t>;
+    using string_view_t = std::basic_string_view<char_t>;
+
+public:
+    explicit basic_reader(string_view_t content)
+        : _begin(content.data()), _cur(content.data()), _end(content.data() + content.size())
+    {
+        _stack.reserve(32);
+    }
+
+    token_type next();
+    // Skip the rest of the value that starts at the current token, so the next call to next()
+    // returns the token after it. For scalars and keys this is a no-op.
+    bool skip();
+
+    token_type token() const noexcept { return _token; }
+    // number of containers enclosing the current token, the root container being depth 1
+    size_t depth() const noexcept { return _stack.size(); }
+    // offset of the parse position in the input, useful to report errors
+    size_t offset() const noexcept { return static_cast<size_t>(_cur - _begin); }
+
+    // text of the current key, string, number or literal; strings are still escaped
+    string_view_t raw() const noexcept { return _raw; }
+    bool has_escape() const noexcept { return _escaped; }
+
+    string_t as_string() const;
+    bool as_boolean() const;
+    long long as_long_long() const;
+    double as_double() const;
+
+private:
+    enum class state : char
+    {
+        start,
+        value,
+        value_or_close,
+        key,
+        key_or_close,
+        after_value,
+        done
+    };
+
+    token_type fail() noexcept
+    {
+        _state = state::done;
+        return _token = token_type::error;
+    }
+    token_type open(char_t ch);
+    token_type close();
+    token_type read_value();
+    token_type read_key();
+
+    const char_t* _begin;
+    const char_t* _cur;
+    const char_t* _end;
+
+    state _state = state::start;
+    token_type _token = token_type::none;
+    string_view_t _raw;
+    bool _escaped = false;
+    // '{' or '[' for every open container
+    std::vector<char_t> _stack;
+};
+
+// ********************************
+// *      sax handler declare     *
+// ********************************
+
+// Default SAX handler: ignores every event. Derive from it and hide the callbacks you need.
+// Returning false from a callback stops parsing, e.g. once the wanted fields have been seen.
+// Keys and strings are passed decoded; they are views into the input unless they contain
+// escapes, in which case they point into a buffer reused between callbacks.
+template <typename char_t>
+struct basic_sax_handler
+{
+    using string_view_t = std::basic_string_view<char_t>;
+
+    bool on_begin_object() { return true; }
+    bool on_end_object() { return true; }
+    bool on_begin_array() { return true; }
+    bool on_end_array() { return true; }
+    bool on_key(string_view_t) { return true; }
+    bool on_string(string_view_t) { return true; }
+    // raw number text, as it appears in the input
+    bool on_number(string_view_t) { return true; }
+    bool on_boolean(bool) { return true; }
+    bool on_null() { return true; }
+};
+
+enum class sax_result : char
+{
+    completed,
+    stopped,
+    error
+};
+
+template <typename handler_t, typename char_t, typename accel_traits = packed_bytes_trait_max>
+sax_result sax_parse(std::basic_string_view<char_t> content, handler_t& handler);
+
+template <typename handler_t, typename string_t>
+sax_result sax_parse(const string_t& content, handler_t& handler);
+
+// **************************
+// *      reader impl       *
+// **************************
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE token_type basic_reader<char_t, accel_traits>::next()
+{
+    _raw = {};
+    _escaped = false;
+
+    switch (_state) {
+    case state::start:
+        if (!_parser_helper::skip_whitespace<accel_traits>(_cur, _end)) {
+            return fail();
+        }
+        // A JSON payload should be an object or array
+        if (*_cur != '{' && *_cur != '[') {
+            return fail();
+        }
+        return open(*_cur);
+
+    case state::value_or_close:
+        if (!_parser_helper::skip_whitespace<accel_traits>(_cur, _end)) {
+            return fail();
+        }
+        if (*_cur == ']') {
+            return close();
+        }
+        return read_value();
+
+    case state::value:
+        return read_value();
+
+    case state::key_or_close:
+        if (!_parser_helper::skip_whitespace<accel_traits>(_cur, _end)) {
+            return fail();
+        }
+        if (*_cur == '}') {
+            return close();
+        }
+        return read_key();
+
+    case state::key:
+        return read_key();
+
+    case state::after_value:
+        if (_stack.empty()) {
+            // After the parsing is complete, there should be no more content other than spaces behind
+            _state = state::done;
+            return _token = _parser_helper::skip_whitespace<accel_traits>(_cur, _end) ? fail() : token_type::end_of_input;
+        }
+        if (!_parser_helper::skip_whitespace<accel_traits>(_cur, _end)) {
+            return fail();
+        }
+        if (*_cur == ',') {
+            ++_cur;
+            _state = _stack.back() == '{' ? state::key : state::value;
+            return next();
+        }
+        return close();
+
+    case state::done:
+    default:
+        return _token;
+    }
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE bool basic_reader<char_t, accel_traits>::skip()
+{
+    if (_token != token_type::begin_object && _token != token_type::begin_array) {
+        return _token != token_type::error;
+    }
+    const size_t target = _stack.size() - 1;
+    while (_stack.size() > target) {
+        if (next() == token_type::error) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE token_type basic_reader<char_t, accel_traits>::open(char_t ch)
+{
+    ++_cur;
+    _stack.push_back(ch);
+    if (ch == '{') {
+        _state = state::key_or_close;
+        return _token = token_type::begin_object;
+    }
+    _state = state::value_or_close;
+    return _token = token_type::begin_array;
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE token_type basic_reader<char_t, accel_traits>::close()
+{
+    const char_t expected = _stack.back() == '{' ? '}' : ']';
+    if (*_cur != expected) {
+        return fail();
+    }
+    ++_cur;
+    _stack.pop_back();
+    _state = state::after_value;
+    return _token = expected == '}' ? token_type::end_object : token_type::end_array;
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE token_type basic_reader<char_t, accel_traits>::read_key()
+{
+    if (!_parser_helper::skip_whitespace<accel_traits>(_cur, _end) || *_cur != '"') {
+        return fail();
+    }
+    const auto first = ++_cur;
+    if (!_parser_helper::scan_string_literal<accel_traits>(_cur, _end, _escaped)) {
+        return fail();
+    }
+    _raw = string_view_t(first, static_cast<size_t>(_cur - first));
+    ++_cur;
+    if (!_parser_helper::skip_whitespace<accel_traits>(_cur, _end) || *_cur != ':') {
+        return fail();
+    }
+    ++_cur;
+    _state = state::value;
+    return _token = token_type::key;
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE token_type basic_reader<char_t, accel_traits>::read_value()
+{
+    if (!_parser_helper::skip_whitespace<accel_traits>(_cur, _end)) {
+        return fail();
+    }
+
+    auto literal = [&](std::initializer_list<char_t> text, token_type type) {
+        const auto first = _cur;
+        for (const auto& ch : text) {
+            if (_cur == _end || *_cur != ch) {
+                return fail();
+            }
+            ++_cur;
+        }
+        _raw = string_view_t(first, text.size());
+        _state = state::after_value;
+        return _token = type;
+    };
+
+    switch (*_cur) {
+    case '{':
+    case '[':
+        return open(*_cur);
+    case 'n':
+        return literal({ 'n', 'u', 'l', 'l' }, token_type::null);
+    case 't':
+        return literal({ 't', 'r', 'u', 'e' }, token_type::boolean);
+    case 'f':
+        return literal({ 'f', 'a', 'l', 's', 'e' }, token_type::boolean);
+    case '"': {
+        const auto first = ++_cur;
+        if (!_parser_helper::scan_string_literal<accel_traits>(_cur, _end, _escaped)) {
+            return fail();
+        }
+        _raw = string_view_t(first, static_cast<size_t>(_cur - first));
+        ++_cur;
+        _state = state::after_value;
+        return _token = token_type::string;
+    }
+    default: {
+        const auto first = _cur;
+        if ((*_cur != '-' && !_parser_helper::is_digit(*_cur)) || !_parser_helper::scan_number(_cur, _end)) {
+            return fail();
+        }
+        _raw = string_view_t(first, static_cast<size_t>(_cur - first));
+        _state = state::after_value;
+        return _token = token_type::number;
+    }
+    }
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE typename basic_reader<char_t, accel_traits>::string_t basic_reader<char_t, accel_traits>::as_string()
+    const
+{
+    if (_token != token_type::string && _token != token_type::key) {
+        throw exception("Wrong Type");
+    }
+    string_t result;
+    if (_escaped) {
+        _parser_helper::decode_string_literal(_raw, result);
+    }
+    else {
+        result = _raw;
+    }
+    return result;
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE bool basic_reader<char_t, accel_traits>::as_boolean() const
+{
+    if (_token != token_type::boolean) {
+        throw exception("Wrong Type");
+    }
+    return _raw.front() == 't';
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE long long basic_reader<char_t, accel_traits>::as_long_long() const
+{
+    if (_token != token_type::number) {
+        throw exception("Wrong Type");
+    }
+    return _number_helper::from_chars<long long, char_t>(_raw);
+}
+
+template <typename char_t, typename accel_traits>
+MEOJSON_INLINE double basic_reader<char_t, accel_traits>::as_double() const
+{
+    if (_token != token_type::number) {
+        throw exception("Wrong Type");
+    }
+    return _number_helper::from_chars<double, char_t>(_raw);
+}
+
+// ***********************
+// *      sax impl       *
+// ***********************
+
+template <typename handler_t, typename char_t, typename accel_traits>
+MEOJSON_INLINE sax_result sax_parse(std::basic_string_view<char_t> content, handler_t& handler)
+{
+    using string_view_t = std::basic_string_view<char_t>;
+
+    basic_reader<char_t, accel_traits> reader(content);
+    std::basic_string<char_t> unescaped;
+    auto decoded = [&]() -> string_view_t {
+        if (!reader.has_escape()) {
+            return reader.raw();
+        }
+        unescaped.clear();
+        _parser_helper::decode_string_literal(reader.raw(), unescaped);
+        return unescaped;
+    };
+
+    while (true) {
+        bool go_on = true;
+        switch (reader.next()) {
+        case token_type::begin_object:
+            go_on = handler.on_begin_object();
+            break;
+        case token_type::end_object:
+            go_on = handler.on_end_object();
+            break;
+        case token_type::begin_array:
+            go_on = handler.on_begin_array();
+            break;
+        case token_type::end_array:
+            go_on = handler.on_end_array();
+            break;
+        case token_type::key:
+            go_on = handler.on_key(decoded());
+            break;
+        case token_type::string:
+            go_on = handler.on_string(decoded());
+            break;
+        case token_type::number:
+            go_on = handler.on_number(reader.raw());
+            break;
+        case token_type::boolean:
+            go_on = handler.on_boolean(reader.as_boolean());
+            break;
+        case token_type::null:
+            go_on = handler.on_null();
+            break;
+        case token_type::end_of_input:
+            return sax_result::completed;
+        case token_type::error:
+        default:
+            return sax_result::error;
+        }
+        if (!go_on) {
+            return sax_result::stopped;
+        }
+    }
+}
+
+template <typename handler_t, typename string_t>
+MEOJSON_INLINE sax_result sax_parse(const string_t& content, handler_t& handler)
+{
+    using char_t = typename string_t::value_type;
+    return sax_parse<handler_t, char_t>(std::basic_string_view<char_t>(content), handler);
+}
+} // namespace json
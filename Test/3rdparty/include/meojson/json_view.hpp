@@ -0,0 +1,571 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "json.hpp"
+
+namespace json
+{
+template <typename char_t>
+class basic_document;
+template <typename char_t>
+class basic_view;
+
+using document = basic_document<char>;
+using view = basic_view<char>;
+
+using wdocument = basic_document<wchar_t>;
+using wview = basic_view<wchar_t>;
+
+// *********************************
+// *      basic_view declare       *
+// *********************************
+
+// A read-only handle to one value of a basic_document.
+// Strings, keys and numbers are string_views into the parsed buffer, which must outlive the document.
+// Escape sequences are only decoded when as_string() is called on a literal that contains them.
+template <typename char_t>
+class basic_view
+{
+public:
+    using string_t = std::basic_string<char_t>;
+    using string_view_t = std::basic_string_view<char_t>;
+    using value_type = typename basic_value<string_t>::value_type;
+
+    template <bool is_member>
+    class child_iterator;
+    template <bool is_member>
+    class child_range;
+
+    using element_range = child_range<false>;
+    using member_range = child_range<true>;
+
+public:
+    basic_view() = default;
+    basic_view(const basic_view&) = default;
+    basic_view& operator=(const basic_view&) = default;
+
+    bool valid() const noexcept { return _doc != nullptr; }
+    value_type type() const noexcept { return valid() ? self().type : value_type::invalid; }
+    bool is_null() const noexcept { return type() == value_type::null; }
+    bool is_number() const noexcept { return type() == value_type::number; }
+    bool is_boolean() const noexcept { return type() == value_type::boolean; }
+    bool is_string() const noexcept { return type() == value_type::string; }
+    bool is_array() const noexcept { return type() == value_type::array; }
+    bool is_object() const noexcept { return type() == value_type::object; }
+
+    // element count of an array, member count of an object, 0 otherwise
+    size_t size() const noexcept { return valid() ? self().size : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    // source text of a scalar; for strings, the still-escaped content between the quotes
+    string_view_t raw() const noexcept { return valid() ? self().text : string_view_t {}; }
+    bool has_escape() const noexcept { return valid() && self().escaped; }
+
+    bool contains(string_view_t key) const { return find(key).has_value(); }
+    bool contains(size_t pos) const { return is_array() && pos < size(); }
+    std::optional<basic_view> find(string_view_t key) const;
+    std::optional<basic_view> find(size_t pos) const;
+    basic_view at(string_view_t key) const;
+    basic_view at(size_t pos) const;
+
+    bool as_boolean() const;
+    int as_integer() const { return _number_helper::numeric_cast<int>(as_long_long()); }
+    long long as_long_long() const;
+    double as_double() const;
+    // only valid for strings without escapes, see has_escape()
+    string_view_t as_string_view() const;
+    string_t as_string() const;
+    // copy this subtree into an owning basic_value
+    basic_value<string_t> as_value() const;
+
+    element_range elements() const;
+    member_range members() const;
+
+private:
+    friend class basic_document<char_t>;
+
+    basic_view(const basic_document<char_t>* doc, uint32_t index) noexcept : _doc(doc), _index(index) {}
+
+    const auto& self() const noexcept { return _doc->_nodes[_index]; }
+    static uint32_t next_sibling(const basic_document<char_t>* doc, uint32_t index) noexcept
+    {
+        return doc->_nodes[index].next;
+    }
+    static string_t decode(string_view_t raw);
+
+    const basic_document<char_t>* _doc = nullptr;
+    uint32_t _index = 0;
+};
+
+template <typename char_t>
+template <bool is_member>
+class basic_view<char_t>::child_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::conditional_t<is_member, std::pair<basic_view, basic_view>, basic_view>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    child_iterator() = default;
+    child_iterator(const basic_document<char_t>* doc, uint32_t index) noexcept : _doc(doc), _index(index) {}
+
+    value_type operator*() const
+    {
+        if constexpr (is_member) {
+            return { basic_view(_doc, _index), basic_view(_doc, _index + 1) };
+        }
+        else {
+            return basic_view(_doc, _index);
+        }
+    }
+    child_iterator& operator++() noexcept
+    {
+        // a member is a key node immediately followed by its value subtree
+        _index = next_sibling(_doc, is_member ? _index + 1 : _index);
+        return *this;
+    }
+    child_iterator operator++(int) noexcept
+    {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+    bool operator==(const child_iterator& rhs) const noexcept { return _index == rhs._index; }
+    bool operator!=(const child_iterator& rhs) const noexcept { return _index != rhs._index; }
+
+private:
+    const basic_document<char_t>* _doc = nullptr;
+    uint32_t _index = 0;
+};
+
+template <typename char_t>
+template <bool is_member>
+class basic_view<char_t>::child_range
+{
+public:
+    using iterator = child_iterator<is_member>;
+
+    child_range() = default;
+    child_range(iterator first, iterator last) noexcept : _begin(first), _end(last) {}
+
+    iterator begin() const noexcept { return _begin; }
+    iterator end() const noexcept { return _end; }
+
+private:
+    iterator _begin;
+    iterator _end;
+};
+
+// *************************************
+// *      basic_document declare       *
+// *************************************
+
+// Owns the flattened node table of a parsed JSON text, but not the text itself.
+// All nodes live in one contiguous vector in pre-order, so parsing costs a handful of
+// allocations no matter how many values or strings the input contains.
+template <typename char_t>
+class basic_document
+{
+public:
+    using string_view_t = std::basic_string_view<char_t>;
+    using view_t = basic_view<char_t>;
+
+public:
+    basic_document() = default;
+    basic_document(const basic_document&) = delete;
+    basic_document(basic_document&&) noexcept = default;
+    basic_document& operator=(const basic_document&) = delete;
+    basic_document& operator=(basic_document&&) noexcept = default;
+    ~basic_document() = default;
+
+    // `content` must stay alive and unchanged for as long as the document is used
+    template <typename accel_traits = packed_bytes_trait_max>
+    static std::optional<basic_document> parse(string_view_t content);
+
+    bool empty() const noexcept { return _nodes.empty(); }
+    view_t root() const noexcept { return empty() ? view_t() : view_t(this, 0); }
+
+private:
+    friend class basic_view<char_t>;
+
+    struct node
+    {
+        typename view_t::value_type type = view_t::value_type::invalid;
+        bool escaped = false;
+        uint32_t size = 0;
+        // index of the first node after this subtree
+        uint32_t next = 0;
+        string_view_t text;
+    };
+
+    template <typename accel_traits>
+    class view_parser;
+
+    std::vector<node> _nodes;
+};
+
+// ******************************
+// *      basic_view impl       *
+// ******************************
+
+template <typename char_t>
+MEOJSON_INLINE std::optional<basic_view<char_t>> basic_view<char_t>::find(string_view_t key) const
+{
+    if (!is_object()) {
+        return std::nullopt;
+    }
+    for (auto&& [k, v] : members()) {
+        if (k.has_escape() ? decode(k.raw()) == key : k.raw() == key) {
+            return v;
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename char_t>
+MEOJSON_INLINE std::optional<basic_view<char_t>> basic_view<char_t>::find(size_t pos) const
+{
+    if (!contains(pos)) {
+        return std::nullopt;
+    }
+    auto iter = elements().begin();
+    std::advance(iter, pos);
+    return *iter;
+}
+
+template <typename char_t>
+MEOJSON_INLINE basic_view<char_t> basic_view<char_t>::at(string_view_t key) const
+{
+    auto opt = find(key);
+    if (!opt) {
+        throw exception("Key not found");
+    }
+    return *opt;
+}
+
+template <typename char_t>
+MEOJSON_INLINE basic_view<char_t> basic_view<char_t>::at(size_t pos) const
+{
+    auto opt = find(pos);
+    if (!opt) {
+        throw exception("Out of range");
+    }
+    return *opt;
+}
+
+template <typename char_t>
+MEOJSON_INLINE bool basic_view<char_t>::as_boolean() const
+{
+    if (!is_boolean()) {
+        throw exception("Wrong Type");
+    }
+    return raw().front() == 't';
+}
+
+template <typename char_t>
+MEOJSON_INLINE long long basic_view<char_t>::as_long_long() const
+{
+    if (!is_number()) {
+        throw exception("Wrong Type");
+    }
+    return _number_helper::from_chars<long long, char_t>(raw());
+}
+
+template <typename char_t>
+MEOJSON_INLINE double basic_view<char_t>::as_double() const
+{
+    if (!is_number()) {
+        throw exception("Wrong Type");
+    }
+    return _number_helper::from_chars<double, char_t>(raw());
+}
+
+template <typename char_t>
+MEOJSON_INLINE typename basic_view<char_t>::string_view_t basic_view<char_t>::as_string_view() const
+{
+    if (!is_string()) {
+        throw exception("Wrong Type");
+    }
+    if (has_escape()) {
+        throw exception("String contains escape sequences, use as_string()");
+    }
+    return raw();
+}
+
+template <typename char_t>
+MEOJSON_INLINE typename basic_view<char_t>::string_t basic_view<char_t>::as_string() const
+{
+    if (!is_string()) {
+        throw exception("Wrong Type");
+    }
+    return has_escape() ? decode(raw()) : string_t(raw());
+}
+
+template <typename char_t>
+MEOJSON_INLINE basic_value<std::basic_string<char_t>> basic_view<char_t>::as_value() const
+{
+    switch (type()) {
+    case value_type::null:
+        return basic_value<string_t>();
+    case value_type::boolean:
+        return as_boolean();
+    case value_type::number:
+        return basic_value<string_t>(value_type::number, string_t(raw()));
+    case value_type::string:
+        return as_string();
+    case value_type::array: {
+        typename basic_array<string_t>::raw_array result;
+        result.reserve(size());
+        for (auto&& elem : elements()) {
+            result.emplace_back(elem.as_value());
+        }
+        return basic_array<string_t>(std::move(result));
+    }
+    case value_type::object: {
+        typename basic_object<string_t>::raw_object result;
+        for (auto&& [key, val] : members()) {
+            result.emplace(key.as_string(), val.as_value());
+        }
+        return basic_object<string_t>(std::move(result));
+    }
+    default:
+        return invalid_value<string_t>();
+    }
+}
+
+template <typename char_t>
+MEOJSON_INLINE typename basic_view<char_t>::element_range basic_view<char_t>::elements() const
+{
+    if (!is_array()) {
+        return {};
+    }
+    return { { _doc, _index + 1 }, { _doc, self().next } };
+}
+
+template <typename char_t>
+MEOJSON_INLINE typename basic_view<char_t>::member_range basic_view<char_t>::members() const
+{
+    if (!is_object()) {
+        return {};
+    }
+    return { { _doc, _index + 1 }, { _doc, self().next } };
+}
+
+template <typename char_t>
+MEOJSON_INLINE typename basic_view<char_t>::string_t basic_view<char_t>::decode(string_view_t raw)
+{
+    string_t result;
+    _parser_helper::decode_string_literal(raw, result);
+    return result;
+}
+
+// **********************************
+// *      basic_document impl       *
+// **********************************
+
+template <typename char_t>
+template <typename accel_traits>
+class basic_document<char_t>::view_parser
+{
+public:
+    using value_type = typename view_t::value_type;
+    using iter_t = const char_t*;
+
+    view_parser(std::vector<node>& nodes, string_view_t content) noexcept
+        : _nodes(nodes), _cur(content.data()), _end(content.data() + content.size())
+    {
+        ;
+    }
+
+    bool parse()
+    {
+        if (!skip_whitespace() || (*_cur != '[' && *_cur != '{')) {
+            // A JSON payload should be an object or array
+            return false;
+        }
+        if (!parse_value()) {
+            return false;
+        }
+        // After the parsing is complete, there should be no more content other than spaces behind
+        return !skip_whitespace();
+    }
+
+private:
+    bool parse_value()
+    {
+        switch (*_cur) {
+        case 'n':
+            return parse_literal({ 'n', 'u', 'l', 'l' }, value_type::null);
+        case 't':
+            return parse_literal({ 't', 'r', 'u', 'e' }, value_type::boolean);
+        case 'f':
+            return parse_literal({ 'f', 'a', 'l', 's', 'e' }, value_type::boolean);
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return parse_number();
+        case '"':
+            return parse_string();
+        case '[':
+            return parse_array();
+        case '{':
+            return parse_object();
+        default:
+            return false;
+        }
+    }
+
+    bool parse_literal(std::initializer_list<char_t> literal, value_type type)
+    {
+        const auto first = _cur;
+        for (const auto& ch : literal) {
+            if (_cur == _end || *_cur != ch) {
+                return false;
+            }
+            ++_cur;
+        }
+        push_leaf(type, string_view_t(first, literal.size()), false);
+        return true;
+    }
+
+    bool parse_number()
+    {
+        const auto first = _cur;
+        if (!_parser_helper::scan_number(_cur, _end)) {
+            return false;
+        }
+        push_leaf(value_type::number, string_view_t(first, static_cast<size_t>(_cur - first)), false);
+        return true;
+    }
+
+    bool parse_string()
+    {
+        ++_cur; // '"'
+        const auto first = _cur;
+        bool escaped = false;
+        if (!_parser_helper::scan_string_literal<accel_traits>(_cur, _end, escaped)) {
+            return false;
+        }
+        push_leaf(value_type::string, string_view_t(first, static_cast<size_t>(_cur - first)), escaped);
+        ++_cur; // '"'
+        return true;
+    }
+
+    bool parse_array()
+    {
+        ++_cur; // '['
+        const auto self = open_container(value_type::array);
+
+        if (!skip_whitespace()) {
+            return false;
+        }
+        if (*_cur != ']') {
+            while (true) {
+                if (!skip_whitespace() || !parse_value() || !skip_whitespace()) {
+                    return false;
+                }
+                ++_nodes[self].size;
+                if (*_cur != ',') {
+                    break;
+                }
+                ++_cur;
+            }
+            if (!skip_whitespace() || *_cur != ']') {
+                return false;
+            }
+        }
+        ++_cur;
+        close_container(self);
+        return true;
+    }
+
+    bool parse_object()
+    {
+        ++_cur; // '{'
+        const auto self = open_container(value_type::object);
+
+        if (!skip_whitespace()) {
+            return false;
+        }
+        if (*_cur != '}') {
+            while (true) {
+                if (!skip_whitespace() || *_cur != '"' || !parse_string()) {
+                    return false;
+                }
+                if (!skip_whitespace() || *_cur != ':') {
+                    return false;
+                }
+                ++_cur;
+                if (!skip_whitespace() || !parse_value() || !skip_whitespace()) {
+                    return false;
+                }
+                ++_nodes[self].size;
+                if (*_cur != ',') {
+                    break;
+                }
+                ++_cur;
+            }
+            if (!skip_whitespace() || *_cur != '}') {
+                return false;
+            }
+        }
+        ++_cur;
+        close_container(self);
+        return true;
+    }
+
+    void push_leaf(value_type type, string_view_t text, bool escaped)
+    {
+        auto index = static_cast<uint32_t>(_nodes.size());
+        _nodes.push_back(node { type, escaped, 0, index + 1, text });
+    }
+
+    uint32_t open_container(value_type type)
+    {
+        auto index = static_cast<uint32_t>(_nodes.size());
+        _nodes.push_back(node { type, false, 0, 0, {} });
+        return index;
+    }
+
+    void close_container(uint32_t index) { _nodes[index].next = static_cast<uint32_t>(_nodes.size()); }
+
+    bool skip_whitespace() noexcept { return _parser_helper::skip_whitespace<accel_traits>(_cur, _end); }
+
+    std::vector<node>& _nodes;
+    iter_t _cur;
+    iter_t _end;
+};
+
+template <typename char_t>
+template <typename accel_traits>
+MEOJSON_INLINE std::optional<basic_document<char_t>> basic_document<char_t>::parse(string_view_t content)
+{
+    basic_document<char_t> doc;
+    // about one byte of table per byte of input, enough for indented files; denser input grows the table as
+    // usual, and shrink_to_fit drops the rest once the count is known
+    doc._nodes.reserve(content.size() * sizeof(char_t) / sizeof(node) + 1);
+    if (!view_parser<accel_traits>(doc._nodes, content).parse()) {
+        return std::nullopt;
+    }
+    doc._nodes.shrink_to_fit();
+    return doc;
+}
+} // namespace json
@@ -118,9 +118,28 @@ struct packed_bytes<4> {
 template <size_t N>
 using packed_bytes_trait = typename packed_bytes<N>::traits;
 
-using packed_bytes_trait_max = std::conditional_t<packed_bytes_trait<32>::available, packed_bytes_trait<32>,
-  std::conditional_t<packed_bytes_trait<16>::available, packed_bytes_trait<16>,
-    std::conditional_t<packed_bytes_trait<8>::available, packed_bytes_trait<8>,
-      packed_bytes_trait<4>
-  >>>;
+// widest trait enabled at compile time
+using packed_bytes_trait_static_max = std::conditional_t<packed_bytes_trait<64>::available, packed_bytes_trait<64>,
+  std::conditional_t<packed_bytes_trait<32>::available, packed_bytes_trait<32>,
+    std::conditional_t<packed_bytes_trait<16>::available, packed_bytes_trait<16>,
+      std::conditional_t<packed_bytes_trait<8>::available, packed_bytes_trait<8>,
+        packed_bytes_trait<4>
+  >>>>;
+
+// The static trait is inlined into the parser, while packed_bytes_trait_dispatch costs an indirect call per
+// string literal and per whitespace run, which short task strings never win back. Define
+// MEOJSON_ENABLE_RUNTIME_DISPATCH to let the CPU decide at runtime anyway, e.g. for documents of long strings
+// in a build that does not target AVX2, or pass packed_bytes_trait_dispatch to a single parser.
+#if defined(__packed_bytes_trait_dispatch_available) && defined(MEOJSON_ENABLE_RUNTIME_DISPATCH) && \
+    !defined(__AVX512BW__)
+using packed_bytes_trait_max = packed_bytes_trait_dispatch;
+#else
+using packed_bytes_trait_max = packed_bytes_trait_static_max;
+#endif
+
+template <typename traits, typename = void>
+constexpr bool packed_bytes_is_runtime_dispatch = false;
+template <typename traits>
+constexpr bool packed_bytes_is_runtime_dispatch<traits, std::void_t<decltype(traits::runtime_dispatch)>> =
+    traits::runtime_dispatch;
 
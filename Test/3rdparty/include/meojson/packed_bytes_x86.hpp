@@ -54,6 +54,16 @@ struct packed_bytes_trait_sse {
         auto mask = (uint16_t)_mm_movemask_epi8(cmp);
         return json::__bitops::countr_one((uint32_t)mask);
     }
+
+    // the two below expect byte masks as returned by less/equal
+    __packed_bytes_strong_inline static bool is_all_one(value_type x) {
+        return (uint16_t)_mm_movemask_epi8(x) == UINT16_C(0xFFFF);
+    }
+
+    __packed_bytes_strong_inline static size_t first_zero_byte(value_type x) {
+        auto mask = (uint16_t)_mm_movemask_epi8(x);
+        return json::__bitops::countr_one((uint32_t)mask);
+    }
 };
 
 template <>
@@ -62,21 +72,36 @@ struct packed_bytes<16> {
 };
 
 
-#ifdef __AVX2__
+// GCC and Clang can compile AVX2/AVX-512 code per function with the target attribute,
+// MSVC accepts the intrinsics without any /arch flag. Either way the wider traits below
+// can be defined without -mavx2 and picked at runtime.
+#if defined(__GNUC__) || defined(__clang__)
+#define __packed_bytes_target(isa) __attribute__((target(isa)))
+#define __packed_bytes_trait_x86_dispatchable
+#elif defined(_MSC_VER)
+#define __packed_bytes_target(isa)
+#define __packed_bytes_trait_x86_dispatchable
+#else
+#define __packed_bytes_target(isa)
+#endif
+
+#if defined(__AVX2__) || defined(__packed_bytes_trait_x86_dispatchable)
 #include <immintrin.h>
 
+#define __packed_bytes_avx2 __packed_bytes_strong_inline __packed_bytes_target("avx2")
+
 struct packed_bytes_trait_avx2
 {
     static constexpr bool available = true;
     static constexpr auto step = 32;
     using value_type = __m256i;
 
-    __packed_bytes_strong_inline static value_type load_unaligned(const void* ptr)
+    __packed_bytes_avx2 static value_type load_unaligned(const void* ptr)
     {
         return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
     }
 
-    __packed_bytes_strong_inline static value_type less(value_type x, uint8_t n)
+    __packed_bytes_avx2 static value_type less(value_type x, uint8_t n)
     {
         auto bcast = _mm256_set1_epi8(static_cast<char>(n));
         auto all1 = _mm256_set1_epi8(-1);
@@ -86,38 +111,231 @@ struct packed_bytes_trait_avx2
         return is_less;
     }
 
-    __packed_bytes_strong_inline static value_type equal(value_type x, uint8_t n)
+    __packed_bytes_avx2 static value_type equal(value_type x, uint8_t n)
     {
         return _mm256_cmpeq_epi8(x, _mm256_set1_epi8(static_cast<char>(n)));
     }
 
-    __packed_bytes_strong_inline static value_type equal(value_type x, value_type y)
+    __packed_bytes_avx2 static value_type equal(value_type x, value_type y)
     {
         return _mm256_cmpeq_epi8(x, y);
     }
 
-    __packed_bytes_strong_inline static value_type bitwise_or(value_type a, value_type b)
+    __packed_bytes_avx2 static value_type bitwise_or(value_type a, value_type b)
     {
         return _mm256_or_si256(a, b);
     }
 
-    __packed_bytes_strong_inline static bool is_all_zero(value_type x)
+    __packed_bytes_avx2 static bool is_all_zero(value_type x)
     {
         return (bool)_mm256_testz_si256(x, x);
     }
 
-    __packed_bytes_strong_inline static size_t first_nonzero_byte(value_type x)
+    __packed_bytes_avx2 static size_t first_nonzero_byte(value_type x)
     {
         auto cmp = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0));
         auto mask = (uint32_t)_mm256_movemask_epi8(cmp);
-        // AVX512 alternative: _mm_cmpeq_epi8_mask
         return json::__bitops::countr_one(mask);
     }
+
+    __packed_bytes_avx2 static bool is_all_one(value_type x)
+    {
+        return (uint32_t)_mm256_movemask_epi8(x) == UINT32_C(0xFFFFFFFF);
+    }
+
+    __packed_bytes_avx2 static size_t first_zero_byte(value_type x)
+    {
+        return json::__bitops::countr_one((uint32_t)_mm256_movemask_epi8(x));
+    }
+};
+
+#define __packed_bytes_avx512bw __packed_bytes_strong_inline __packed_bytes_target("avx512f,avx512bw")
+
+// AVX-512BW compares produce a 64-bit mask register rather than a vector,
+// so everything after load_unaligned works on __mmask64.
+struct packed_bytes_trait_avx512bw
+{
+    static constexpr bool available = true;
+    static constexpr auto step = 64;
+    using value_type = __m512i;
+    using mask_type = __mmask64;
+
+    __packed_bytes_avx512bw static value_type load_unaligned(const void* ptr)
+    {
+        return _mm512_loadu_si512(ptr);
+    }
+
+    __packed_bytes_avx512bw static mask_type less(value_type x, uint8_t n)
+    {
+        return _mm512_cmplt_epu8_mask(x, _mm512_set1_epi8(static_cast<char>(n)));
+    }
+
+    __packed_bytes_avx512bw static mask_type equal(value_type x, uint8_t n)
+    {
+        return _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(static_cast<char>(n)));
+    }
+
+    __packed_bytes_avx512bw static mask_type equal(value_type x, value_type y)
+    {
+        return _mm512_cmpeq_epi8_mask(x, y);
+    }
+
+    __packed_bytes_strong_inline static mask_type bitwise_or(mask_type a, mask_type b)
+    {
+        return a | b;
+    }
+
+    __packed_bytes_strong_inline static bool is_all_zero(mask_type x)
+    {
+        return x == 0;
+    }
+
+    __packed_bytes_strong_inline static size_t first_nonzero_byte(mask_type x)
+    {
+        return json::__bitops::countr_zero((uint64_t)x);
+    }
+
+    __packed_bytes_strong_inline static bool is_all_one(mask_type x)
+    {
+        return (uint64_t)x == ~UINT64_C(0);
+    }
+
+    __packed_bytes_strong_inline static size_t first_zero_byte(mask_type x)
+    {
+        return json::__bitops::countr_one((uint64_t)x);
+    }
 };
+#endif
 
+#ifdef __AVX2__
 template <>
 struct packed_bytes<32> {
     using traits = packed_bytes_trait_avx2;
 };
+#endif
+
+#ifdef __AVX512BW__
+template <>
+struct packed_bytes<64> {
+    using traits = packed_bytes_trait_avx512bw;
+};
+#endif
+
+#if defined(__packed_bytes_trait_x86_dispatchable) && !defined(MEOJSON_DISABLE_RUNTIME_DISPATCH)
+#define __packed_bytes_trait_dispatch_available
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace __packed_bytes_dispatch
+{
+    // Both scanners return how many leading bytes of [ptr, ptr + len) can be skipped.
+    // They stop at the first byte of interest, or when fewer than 16 bytes remain;
+    // the caller finishes the tail byte by byte.
+#define __packed_bytes_define_scanners(suffix, isa, traits, fallback)                                           \
+    __packed_bytes_target(isa) inline size_t skip_string_literal_##suffix(const char* ptr, size_t len)           \
+    {                                                                                                         \
+        size_t pos = 0;                                                                                       \
+        for (; len - pos >= size_t(traits::step); pos += traits::step) {                                       \
+            auto pack = traits::load_unaligned(ptr + pos);                                                    \
+            auto result = traits::less(pack, 32);                                                             \
+            result = traits::bitwise_or(result, traits::equal(pack, static_cast<uint8_t>('"')));              \
+            result = traits::bitwise_or(result, traits::equal(pack, static_cast<uint8_t>('\\')));             \
+            if (!traits::is_all_zero(result)) {                                                               \
+                return pos + traits::first_nonzero_byte(result);                                              \
+            }                                                                                                 \
+        }                                                                                                     \
+        return pos + fallback(skip_string_literal, ptr + pos, len - pos);                                     \
+    }                                                                                                         \
+    __packed_bytes_target(isa) inline size_t skip_whitespace_##suffix(const char* ptr, size_t len)               \
+    {                                                                                                         \
+        size_t pos = 0;                                                                                       \
+        for (; len - pos >= size_t(traits::step); pos += traits::step) {                                       \
+            auto pack = traits::load_unaligned(ptr + pos);                                                    \
+            auto result = traits::bitwise_or(traits::equal(pack, static_cast<uint8_t>(' ')),                  \
+                                             traits::equal(pack, static_cast<uint8_t>('\n')));                \
+            result = traits::bitwise_or(result, traits::equal(pack, static_cast<uint8_t>('\r')));             \
+            result = traits::bitwise_or(result, traits::equal(pack, static_cast<uint8_t>('\t')));             \
+            if (!traits::is_all_one(result)) {                                                                \
+                return pos + traits::first_zero_byte(result);                                                 \
+            }                                                                                                 \
+        }                                                                                                     \
+        return pos + fallback(skip_whitespace, ptr + pos, len - pos);                                         \
+    }
 
+#define __packed_bytes_no_fallback(kernel, ptr, len) size_t(0)
+#define __packed_bytes_sse_fallback(kernel, ptr, len) kernel##_sse(ptr, len)
+#define __packed_bytes_avx2_fallback(kernel, ptr, len) kernel##_avx2(ptr, len)
+
+    __packed_bytes_define_scanners(sse, "sse2", packed_bytes_trait_sse, __packed_bytes_no_fallback)
+    __packed_bytes_define_scanners(avx2, "avx2", packed_bytes_trait_avx2, __packed_bytes_sse_fallback)
+    __packed_bytes_define_scanners(avx512bw, "avx512f,avx512bw", packed_bytes_trait_avx512bw,
+                                   __packed_bytes_avx2_fallback)
+
+#undef __packed_bytes_define_scanners
+#undef __packed_bytes_no_fallback
+#undef __packed_bytes_sse_fallback
+#undef __packed_bytes_avx2_fallback
+
+    struct scanners
+    {
+        size_t (*skip_string_literal)(const char*, size_t);
+        size_t (*skip_whitespace)(const char*, size_t);
+    };
+
+    inline scanners select_scanners()
+    {
+        bool avx2 = false;
+        bool avx512bw = false;
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        avx2 = __builtin_cpu_supports("avx2");
+        avx512bw = __builtin_cpu_supports("avx512bw");
+#else
+        int info[4] = {};
+        __cpuid(info, 0);
+        const int max_leaf = info[0];
+        __cpuid(info, 1);
+        // the OS must save the wider registers on context switch
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        const bool os_ymm = (xcr0 & 0x6) == 0x6;
+        const bool os_zmm = (xcr0 & 0xE6) == 0xE6;
+        if (max_leaf >= 7) {
+            __cpuidex(info, 7, 0);
+            avx2 = os_ymm && (info[1] & (1 << 5)) != 0;
+            avx512bw = os_zmm && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+        }
+#endif
+        if (avx512bw) {
+            return { skip_string_literal_avx512bw, skip_whitespace_avx512bw };
+        }
+        if (avx2) {
+            return { skip_string_literal_avx2, skip_whitespace_avx2 };
+        }
+        return { skip_string_literal_sse, skip_whitespace_sse };
+    }
+
+    inline const scanners& get_scanners()
+    {
+        static const scanners selected = select_scanners();
+        return selected;
+    }
+}
+
+// Picks the widest of the SSE / AVX2 / AVX-512BW scanners the running CPU supports.
+// It only provides whole-run scanners instead of the per-block primitives of the other traits.
+struct packed_bytes_trait_dispatch {
+    static constexpr bool available = true;
+    static constexpr bool runtime_dispatch = true;
+    static constexpr auto step = 16;
+
+    static size_t skip_string_literal(const char* ptr, size_t len) {
+        return __packed_bytes_dispatch::get_scanners().skip_string_literal(ptr, len);
+    }
+
+    static size_t skip_whitespace(const char* ptr, size_t len) {
+        return __packed_bytes_dispatch::get_scanners().skip_whitespace(ptr, len);
+    }
+};
 #endif
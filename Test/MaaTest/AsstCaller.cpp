@@ -7,6 +7,7 @@
 #include <meojson/json.hpp>
 
 #include "Assistant.h"
+#include "Common/AsstCompiledTasks.h"
 #include "Common/AsstTypes.h"
 #include "Common/AsstVersion.h"
 //#include "Config/ResourceLoader.h"
@@ -53,4 +54,30 @@ AsstBool AsstRunning(AsstHandle handle)
     }*/
 
     return handle->running() ? AsstTrue : AsstFalse;
-}
\ No newline at end of file
+}
+
+AsstBool AsstCompileTasks(const char* task_json_path, const char* output_path)
+{
+    if (task_json_path == nullptr || output_path == nullptr) {
+        return AsstFalse;
+    }
+
+    auto json_path = asst::utils::path(task_json_path);
+    auto json_opt = asst::utils::open_json(json_path);
+    if (!json_opt) {
+        asst::Log.error("Failed to parse", json_path);
+        return AsstFalse;
+    }
+    asst::TaskTable table;
+    if (!table.load(*json_opt)) {
+        return AsstFalse;
+    }
+    return asst::compile_tasks(table, json_path, asst::utils::path(output_path)) ? AsstTrue : AsstFalse;
+}
+
+const char* AsstGetMsgName(AsstMsgId msg)
+{
+    constexpr std::string_view Unknown {};
+    std::string_view name = asst::AsstMsgNames.to_string(static_cast<asst::AsstMsg>(msg), Unknown);
+    return name.empty() ? nullptr : name.data();
+}
@@ -0,0 +1,515 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Common/AsstTaskTable.h"
+#include "Common/AsstVersion.h"
+#include "Utils/Logger.hpp"
+#include "Utils/Platform.hpp"
+
+namespace asst
+{
+    // Binary form of a task json, written offline by compile_tasks() and mapped back by CompiledTasks.
+    //
+    // Layout: a header, then sections aligned to 8 bytes
+    //   strings   uint32 offsets[count + 1] into the chars that follow; every string is stored once
+    //   ids       uint32 string ids referenced by the list fields of the tasks
+    //   ints      int32 values of special_params
+    //   doubles   double values of templ_thresholds
+    //   tasks     fixed size TaskRecord, in TaskTable position order
+    //   templates string ids of every template file name used, for preloading
+    // The header records the version of the writer and the size and write time of the source json. A snapshot
+    // whose version or source differs is stale, and load_tasks() falls back to the json.
+    namespace compiled_tasks
+    {
+        inline constexpr char Magic[8] = { 'M', 'A', 'A', 'T', 'A', 'S', 'K', '\0' };
+        // bump on every change of the structures below
+        inline constexpr uint32_t FormatVersion = 2;
+
+        struct Section
+        {
+            uint64_t offset = 0;
+            uint64_t count = 0;
+        };
+
+        struct Header
+        {
+            char magic[8] = {};
+            uint32_t format_version = 0;
+            uint32_t header_size = 0;
+            uint32_t version = 0; // string id of asst::Version
+            uint32_t reserved = 0;
+            uint64_t source_size = 0;
+            int64_t source_time = 0;
+            Section strings;
+            uint64_t chars_offset = 0;
+            uint64_t chars_size = 0;
+            Section ids;
+            Section ints;
+            Section doubles;
+            Section tasks;
+            Section templates;
+        };
+
+        // `count` values of a pool, starting at `first`
+        struct ListRef
+        {
+            uint32_t first = 0;
+            uint32_t count = 0;
+        };
+
+        enum TaskFlag : uint8_t
+        {
+            SubErrorIgnored = 1 << 0,
+            Cache = 1 << 1,
+            FullMatch = 1 << 2,
+            IsAscii = 1 << 3,
+            WithoutDet = 1 << 4,
+            ReplaceFull = 1 << 5,
+            Bound = 1 << 6,
+        };
+
+        struct TaskRecord
+        {
+            uint32_t name = 0;
+            uint32_t action = 0; // ProcessTaskAction, its values do not fit in a byte
+            uint8_t algorithm = 0;
+            uint8_t flags = 0;
+            uint16_t reserved = 0;
+            int32_t max_times = 0;
+            int32_t pre_delay = 0;
+            int32_t post_delay = 0;
+            int32_t retry_times = 0;
+            int32_t specific_rect[4] = {};
+            int32_t roi[4] = {};
+            int32_t rect_move[4] = {};
+            ListRef sub;                // ids
+            ListRef next;               // ids
+            ListRef exceeded_next;      // ids
+            ListRef on_error_next;      // ids
+            ListRef reduce_other_times; // ids
+            ListRef special_params;     // ints
+            // text of OcrDetect, templ_names of MatchTemplate, hashes of Hash
+            ListRef strings;            // ids
+            ListRef replace_map;        // ids, two per pair
+            ListRef templ_thresholds;   // doubles
+            int32_t mask_range[2] = {};
+            int32_t dist_threshold = 0;
+        };
+
+        static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) % 8 == 0);
+        static_assert(std::is_trivially_copyable_v<TaskRecord> && sizeof(TaskRecord) % 4 == 0);
+
+        inline int64_t file_time(const std::filesystem::path& path, std::error_code& ec)
+        {
+            return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        }
+    } // namespace compiled_tasks
+
+    // Tasks of a compiled snapshot, read in place from the mapped file
+    class CompiledTasks
+    {
+    public:
+        CompiledTasks() = default;
+        CompiledTasks(const CompiledTasks&) = delete;
+        CompiledTasks(CompiledTasks&&) noexcept = default;
+        CompiledTasks& operator=(const CompiledTasks&) = delete;
+        CompiledTasks& operator=(CompiledTasks&&) noexcept = default;
+
+        // Maps and validates the snapshot. With a non-empty `source`, also fails if that json changed since
+        // the snapshot was compiled.
+        bool open(const std::filesystem::path& path, const std::filesystem::path& source = {});
+        bool valid() const noexcept { return m_header != nullptr; }
+
+        size_t size() const noexcept { return m_tasks.size(); }
+        std::string_view string(uint32_t id) const
+        {
+            return { m_chars + m_string_offsets[id], m_string_offsets[id + 1] - m_string_offsets[id] };
+        }
+        const compiled_tasks::TaskRecord& record(size_t pos) const { return m_tasks[pos]; }
+        std::string_view name(size_t pos) const { return string(m_tasks[pos].name); }
+        auto templates() const
+        {
+            return m_templates | views::transform([this](uint32_t id) { return string(id); });
+        }
+
+        // the same table TaskTable::load() gives for the source json, without parsing it
+        TaskTable to_table() const;
+
+    private:
+        template <typename T>
+        bool map_section(const compiled_tasks::Section& section, std::span<const T>& out) const;
+        bool validate_list(const compiled_tasks::ListRef& list, size_t pool_size) const
+        {
+            return list.first <= pool_size && list.count <= pool_size - list.first;
+        }
+        std::vector<std::string> strings(const compiled_tasks::ListRef& list) const;
+
+        platform::mapped_file m_file;
+        const compiled_tasks::Header* m_header = nullptr;
+        const char* m_chars = nullptr;
+        std::span<const uint32_t> m_string_offsets;
+        std::span<const uint32_t> m_ids;
+        std::span<const int32_t> m_ints;
+        std::span<const double> m_doubles;
+        std::span<const compiled_tasks::TaskRecord> m_tasks;
+        std::span<const uint32_t> m_templates;
+    };
+
+    // writes `table`, loaded from `source`, as a snapshot to `output`
+    inline bool compile_tasks(const TaskTable& table, const std::filesystem::path& source,
+                              const std::filesystem::path& output)
+    {
+        using namespace compiled_tasks;
+
+        std::error_code ec;
+        const uintmax_t source_size = std::filesystem::file_size(source, ec);
+        const int64_t source_time = ec ? 0 : file_time(source, ec);
+        if (ec) {
+            Log.error("Failed to stat", source, ec.message());
+            return false;
+        }
+
+        std::string chars;
+        std::vector<uint32_t> string_offsets { 0 };
+        std::unordered_map<std::string, uint32_t> string_ids;
+        auto intern = [&](const std::string& str) {
+            auto [iter, inserted] = string_ids.try_emplace(str, static_cast<uint32_t>(string_ids.size()));
+            if (inserted) {
+                chars.append(str);
+                string_offsets.emplace_back(static_cast<uint32_t>(chars.size()));
+            }
+            return iter->second;
+        };
+
+        std::vector<uint32_t> ids;
+        std::vector<int32_t> ints;
+        std::vector<double> doubles;
+        std::vector<TaskRecord> records;
+        std::vector<uint32_t> templates;
+        std::unordered_set<uint32_t> template_seen;
+        records.reserve(table.size());
+
+        auto add_strings = [&](const std::vector<std::string>& list) {
+            ListRef ref { static_cast<uint32_t>(ids.size()), static_cast<uint32_t>(list.size()) };
+            for (const auto& str : list) {
+                ids.emplace_back(intern(str));
+            }
+            return ref;
+        };
+        auto add_rect = [](int32_t (&out)[4], const Rect& rect) {
+            out[0] = rect.x;
+            out[1] = rect.y;
+            out[2] = rect.width;
+            out[3] = rect.height;
+        };
+
+        const uint32_t version = intern(Version);
+        for (size_t pos = 0; pos < table.size(); ++pos) {
+            const TaskInfo& task = table.base(pos);
+            TaskRecord record;
+            record.name = intern(task.name);
+            record.algorithm = static_cast<uint8_t>(table.algorithm(pos));
+            record.action = static_cast<uint32_t>(task.action);
+            record.flags = (task.sub_error_ignored ? SubErrorIgnored : 0) | (task.cache ? Cache : 0);
+            record.max_times = task.max_times;
+            record.pre_delay = task.pre_delay;
+            record.post_delay = task.post_delay;
+            record.retry_times = task.retry_times;
+            add_rect(record.specific_rect, task.specific_rect);
+            add_rect(record.roi, task.roi);
+            add_rect(record.rect_move, task.rect_move);
+            record.sub = add_strings(task.sub);
+            record.next = add_strings(task.next);
+            record.exceeded_next = add_strings(task.exceeded_next);
+            record.on_error_next = add_strings(task.on_error_next);
+            record.reduce_other_times = add_strings(task.reduce_other_times);
+            record.special_params = { static_cast<uint32_t>(ints.size()),
+                                      static_cast<uint32_t>(task.special_params.size()) };
+            ints.insert(ints.end(), task.special_params.begin(), task.special_params.end());
+
+            if (const auto* ocr = table.get_if<OcrTaskInfo>(pos)) {
+                record.flags |= (ocr->full_match ? FullMatch : 0) | (ocr->is_ascii ? IsAscii : 0) |
+                                (ocr->without_det ? WithoutDet : 0) | (ocr->replace_full ? ReplaceFull : 0);
+                record.strings = add_strings(ocr->text);
+                record.replace_map = { static_cast<uint32_t>(ids.size()),
+                                       static_cast<uint32_t>(ocr->replace_map.size() * 2) };
+                for (const auto& [from, to] : ocr->replace_map) {
+                    ids.emplace_back(intern(from));
+                    ids.emplace_back(intern(to));
+                }
+            }
+            else if (const auto* match = table.get_if<MatchTaskInfo>(pos)) {
+                record.strings = add_strings(match->templ_names);
+                for (uint32_t i = 0; i < record.strings.count; ++i) {
+                    const uint32_t id = ids[record.strings.first + i];
+                    if (template_seen.emplace(id).second) {
+                        templates.emplace_back(id);
+                    }
+                }
+                record.templ_thresholds = { static_cast<uint32_t>(doubles.size()),
+                                            static_cast<uint32_t>(match->templ_thresholds.size()) };
+                doubles.insert(doubles.end(), match->templ_thresholds.begin(), match->templ_thresholds.end());
+                record.mask_range[0] = match->mask_range.first;
+                record.mask_range[1] = match->mask_range.second;
+            }
+            else if (const auto* hash = table.get_if<HashTaskInfo>(pos)) {
+                record.flags |= hash->bound ? Bound : 0;
+                record.strings = add_strings(hash->hashes);
+                record.dist_threshold = hash->dist_threshold;
+                record.mask_range[0] = hash->mask_range.first;
+                record.mask_range[1] = hash->mask_range.second;
+            }
+            records.emplace_back(record);
+        }
+
+        Header header;
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.format_version = FormatVersion;
+        header.header_size = sizeof(Header);
+        header.version = version;
+        header.source_size = source_size;
+        header.source_time = source_time;
+
+        std::string buffer(sizeof(Header), '\0');
+        auto append = [&](const void* data, size_t bytes) {
+            buffer.resize((buffer.size() + 7) & ~size_t { 7 }, '\0');
+            const size_t offset = buffer.size();
+            buffer.append(static_cast<const char*>(data), bytes);
+            return offset;
+        };
+        auto append_section = [&]<typename T>(const std::vector<T>& values) {
+            return Section { append(values.data(), values.size() * sizeof(T)), values.size() };
+        };
+        header.strings = append_section(string_offsets);
+        header.strings.count = string_offsets.size() - 1;
+        header.chars_offset = append(chars.data(), chars.size());
+        header.chars_size = chars.size();
+        header.ids = append_section(ids);
+        header.ints = append_section(ints);
+        header.doubles = append_section(doubles);
+        header.tasks = append_section(records);
+        header.templates = append_section(templates);
+        std::memcpy(buffer.data(), &header, sizeof(Header));
+
+        // readers never see a half written snapshot
+        auto temp_path = output;
+        temp_path += ".tmp";
+        {
+            std::ofstream ofs(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+                Log.error("Failed to write", temp_path);
+                return false;
+            }
+        }
+        std::filesystem::rename(temp_path, output, ec);
+        if (ec) {
+            Log.error("Failed to rename", temp_path, ec.message());
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    inline bool CompiledTasks::map_section(const compiled_tasks::Section& section, std::span<const T>& out) const
+    {
+        const size_t file_size = m_file.size();
+        if (section.offset % alignof(T) != 0 || section.offset > file_size ||
+            section.count > (file_size - section.offset) / sizeof(T)) {
+            return false;
+        }
+        out = { reinterpret_cast<const T*>(m_file.data() + section.offset), static_cast<size_t>(section.count) };
+        return true;
+    }
+
+    inline bool CompiledTasks::open(const std::filesystem::path& path, const std::filesystem::path& source)
+    {
+        using namespace compiled_tasks;
+
+        *this = CompiledTasks();
+        platform::mapped_file file(path);
+        if (!file.valid() || file.size() < sizeof(Header)) {
+            return false;
+        }
+        const auto* header = reinterpret_cast<const Header*>(file.data());
+        if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->format_version != FormatVersion ||
+            header->header_size != sizeof(Header)) {
+            Log.warn("Unknown compiled tasks format", path);
+            return false;
+        }
+        if (!source.empty()) {
+            std::error_code ec;
+            const uint64_t source_size = std::filesystem::file_size(source, ec);
+            const int64_t source_time = ec ? 0 : file_time(source, ec);
+            if (ec || source_size != header->source_size ||
+                source_time != header->source_time) {
+                Log.info("Compiled tasks", path, "are older than", source);
+                return false;
+            }
+        }
+        m_file = std::move(file);
+
+        // everything the accessors index into is checked once here
+        bool ret = header->strings.count < m_file.size() &&
+                   map_section(Section { header->strings.offset, header->strings.count + 1 }, m_string_offsets);
+        ret = ret && header->chars_offset <= m_file.size() && header->chars_size <= m_file.size() - header->chars_offset;
+        ret = ret && map_section(header->ids, m_ids) && map_section(header->ints, m_ints) &&
+              map_section(header->doubles, m_doubles) && map_section(header->tasks, m_tasks) &&
+              map_section(header->templates, m_templates);
+        if (ret) {
+            m_chars = m_file.data() + header->chars_offset;
+            for (size_t i = 0; ret && i + 1 < m_string_offsets.size(); ++i) {
+                ret = m_string_offsets[i] <= m_string_offsets[i + 1];
+            }
+            ret = ret && m_string_offsets.back() <= header->chars_size;
+        }
+        const size_t string_count = m_string_offsets.empty() ? 0 : m_string_offsets.size() - 1;
+        ret = ret && header->version < string_count;
+        for (size_t i = 0; ret && i < m_ids.size(); ++i) {
+            ret = m_ids[i] < string_count;
+        }
+        for (size_t i = 0; ret && i < m_templates.size(); ++i) {
+            ret = m_templates[i] < string_count;
+        }
+        for (size_t pos = 0; ret && pos < m_tasks.size(); ++pos) {
+            const TaskRecord& record = m_tasks[pos];
+            ret = record.name < string_count && record.algorithm <= static_cast<uint8_t>(AlgorithmType::Hash) &&
+                  !ProcessTaskActionNames.to_string(static_cast<ProcessTaskAction>(record.action), {}).empty() &&
+                  validate_list(record.sub, m_ids.size()) && validate_list(record.next, m_ids.size()) &&
+                  validate_list(record.exceeded_next, m_ids.size()) &&
+                  validate_list(record.on_error_next, m_ids.size()) &&
+                  validate_list(record.reduce_other_times, m_ids.size()) &&
+                  validate_list(record.special_params, m_ints.size()) &&
+                  validate_list(record.strings, m_ids.size()) && validate_list(record.replace_map, m_ids.size()) &&
+                  record.replace_map.count % 2 == 0 && validate_list(record.templ_thresholds, m_doubles.size());
+        }
+        if (!ret) {
+            Log.error("Corrupted compiled tasks", path);
+            *this = CompiledTasks();
+            return false;
+        }
+        m_header = header;
+
+        if (string(header->version) != Version) {
+            Log.info("Compiled tasks", path, "were written by", string(header->version));
+            *this = CompiledTasks();
+            return false;
+        }
+        return true;
+    }
+
+    inline std::vector<std::string> CompiledTasks::strings(const compiled_tasks::ListRef& list) const
+    {
+        std::vector<std::string> result;
+        result.reserve(list.count);
+        for (uint32_t id : m_ids.subspan(list.first, list.count)) {
+            result.emplace_back(string(id));
+        }
+        return result;
+    }
+
+    inline TaskTable CompiledTasks::to_table() const
+    {
+        using namespace compiled_tasks;
+
+        auto fill_base = [&](TaskInfo& task, const TaskRecord& record) {
+            auto rect = [](const int32_t(&in)[4]) { return Rect(in[0], in[1], in[2], in[3]); };
+            task.name = string(record.name);
+            task.action = static_cast<ProcessTaskAction>(record.action);
+            task.sub = strings(record.sub);
+            task.sub_error_ignored = record.flags & SubErrorIgnored;
+            task.next = strings(record.next);
+            task.max_times = record.max_times;
+            task.exceeded_next = strings(record.exceeded_next);
+            task.on_error_next = strings(record.on_error_next);
+            task.reduce_other_times = strings(record.reduce_other_times);
+            task.specific_rect = rect(record.specific_rect);
+            task.pre_delay = record.pre_delay;
+            task.post_delay = record.post_delay;
+            task.retry_times = record.retry_times;
+            task.roi = rect(record.roi);
+            task.rect_move = rect(record.rect_move);
+            task.cache = record.flags & Cache;
+            auto params = m_ints.subspan(record.special_params.first, record.special_params.count);
+            task.special_params.assign(params.begin(), params.end());
+        };
+
+        TaskTable table;
+        for (const TaskRecord& record : m_tasks) {
+            switch (static_cast<AlgorithmType>(record.algorithm)) {
+            case AlgorithmType::OcrDetect: {
+                OcrTaskInfo task;
+                fill_base(task, record);
+                task.text = strings(record.strings);
+                task.full_match = record.flags & FullMatch;
+                task.is_ascii = record.flags & IsAscii;
+                task.without_det = record.flags & WithoutDet;
+                task.replace_full = record.flags & ReplaceFull;
+                auto pairs = m_ids.subspan(record.replace_map.first, record.replace_map.count);
+                task.replace_map.reserve(pairs.size() / 2);
+                for (size_t i = 0; i < pairs.size(); i += 2) {
+                    task.replace_map.emplace_back(string(pairs[i]), string(pairs[i + 1]));
+                }
+                table.push_back(std::move(task));
+            } break;
+            case AlgorithmType::MatchTemplate: {
+                MatchTaskInfo task;
+                fill_base(task, record);
+                task.templ_names = strings(record.strings);
+                auto thresholds = m_doubles.subspan(record.templ_thresholds.first, record.templ_thresholds.count);
+                task.templ_thresholds.assign(thresholds.begin(), thresholds.end());
+                task.mask_range = { record.mask_range[0], record.mask_range[1] };
+                table.push_back(std::move(task));
+            } break;
+            case AlgorithmType::Hash: {
+                HashTaskInfo task;
+                fill_base(task, record);
+                task.hashes = strings(record.strings);
+                task.dist_threshold = record.dist_threshold;
+                task.mask_range = { record.mask_range[0], record.mask_range[1] };
+                task.bound = record.flags & Bound;
+                table.push_back(std::move(task));
+            } break;
+            default: {
+                TaskInfo task;
+                fill_base(task, record);
+                table.push_back(std::move(task));
+            } break;
+            }
+        }
+        return table;
+    }
+
+    // Loads the tasks of `json_path`, from the snapshot at `compiled_path` when it is up to date. Otherwise the
+    // json is parsed and, if that succeeds, the snapshot is rewritten for the next start.
+    inline bool load_tasks(const std::filesystem::path& json_path, const std::filesystem::path& compiled_path,
+                           TaskTable& table)
+    {
+        if (CompiledTasks compiled; compiled.open(compiled_path, json_path)) {
+            table = compiled.to_table();
+            return true;
+        }
+
+        auto json_opt = utils::open_json(json_path);
+        if (!json_opt) {
+            Log.error("Failed to parse", json_path);
+            return false;
+        }
+        if (!table.load(*json_opt)) {
+            return false;
+        }
+        compile_tasks(table, json_path, compiled_path);
+        return true;
+    }
+} // namespace asst
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <array>
 #include <functional>
 #include <ostream>
-#include <unordered_map>
+#include <string_view>
 
 #include <meojson/json.hpp>
 
+#include "Utils/EnumTable.hpp"
+
 namespace asst
 {
     enum class AsstMsg
@@ -30,29 +33,39 @@ namespace asst
         SubTaskStopped,       // ԭֶֹֹͣͣ
     };
 
-    inline std::ostream& operator<<(std::ostream& os, const AsstMsg& type)
-    {
-        static const std::unordered_map<AsstMsg, std::string> _type_name = {
+    // indexed by the layout of AsstMsg: blocks of 10000 ids, one per kind of message
+    inline constexpr utils::SparseEnumNames<AsstMsg, 10000, 3, 16> AsstMsgNames {
+        std::to_array<utils::EnumName<AsstMsg>>({
             /* Global Info */
-            { AsstMsg::InternalError, "InternalError" },
-            { AsstMsg::InitFailed, "InitFailed" },
-            { AsstMsg::ConnectionInfo, "ConnectionInfo" },
-            { AsstMsg::AllTasksCompleted, "AllTasksCompleted" },
-            { AsstMsg::AsyncCallInfo, "AsyncCallInfo" },
+            { "InternalError", AsstMsg::InternalError },
+            { "InitFailed", AsstMsg::InitFailed },
+            { "ConnectionInfo", AsstMsg::ConnectionInfo },
+            { "AllTasksCompleted", AsstMsg::AllTasksCompleted },
+            { "AsyncCallInfo", AsstMsg::AsyncCallInfo },
             /* TaskChain Info */
-            { AsstMsg::TaskChainError, "TaskChainError" },
-            { AsstMsg::TaskChainStart, "TaskChainStart" },
-            { AsstMsg::TaskChainCompleted, "TaskChainCompleted" },
-            { AsstMsg::TaskChainExtraInfo, "TaskChainExtraInfo" },
-            { AsstMsg::TaskChainStopped, "TaskChainStopped" },
+            { "TaskChainError", AsstMsg::TaskChainError },
+            { "TaskChainStart", AsstMsg::TaskChainStart },
+            { "TaskChainCompleted", AsstMsg::TaskChainCompleted },
+            { "TaskChainExtraInfo", AsstMsg::TaskChainExtraInfo },
+            { "TaskChainStopped", AsstMsg::TaskChainStopped },
             /* SubTask Info */
-            { AsstMsg::SubTaskError, "SubTaskError" },
-            { AsstMsg::SubTaskStart, "SubTaskStart" },
-            { AsstMsg::SubTaskCompleted, "SubTaskCompleted" },
-            { AsstMsg::SubTaskExtraInfo, "SubTaskExtraInfo" },
-            { AsstMsg::SubTaskStopped, "SubTaskStopped" },
-        };
-        return os << _type_name.at(type);
+            { "SubTaskError", AsstMsg::SubTaskError },
+            { "SubTaskStart", AsstMsg::SubTaskStart },
+            { "SubTaskCompleted", AsstMsg::SubTaskCompleted },
+            { "SubTaskExtraInfo", AsstMsg::SubTaskExtraInfo },
+            { "SubTaskStopped", AsstMsg::SubTaskStopped },
+        }),
+    };
+
+    // names are string literals, so data() is null terminated
+    constexpr std::string_view enum_to_string(AsstMsg type)
+    {
+        return AsstMsgNames.to_string(type);
+    }
+
+    inline std::ostream& operator<<(std::ostream& os, const AsstMsg& type)
+    {
+        return os << enum_to_string(type);
     }
 
     // Ļصӿ
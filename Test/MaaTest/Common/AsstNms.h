@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+
+namespace asst
+{
+    // intersection over union, 0 when both are empty; the same value rect_batch::iou gives
+    inline float rect_iou(const Rect& lhs, const Rect& rhs) noexcept
+    {
+        const int inter_width =
+            std::max(std::min(lhs.x + lhs.width, rhs.x + rhs.width) - std::max(lhs.x, rhs.x), 0);
+        const int inter_height =
+            std::max(std::min(lhs.y + lhs.height, rhs.y + rhs.height) - std::max(lhs.y, rhs.y), 0);
+        const float inter = static_cast<float>(inter_width) * static_cast<float>(inter_height);
+        const float united = static_cast<float>(lhs.width) * static_cast<float>(lhs.height) +
+                             static_cast<float>(rhs.width) * static_cast<float>(rhs.height) - inter;
+        return united > 0 ? inter / united : 0;
+    }
+
+    // MatchRect, TextRect or anything else with a rect and a score
+    template <typename ResultT>
+    concept ScoredRect = requires(ResultT& result) {
+        { result.rect } -> std::convertible_to<Rect&>;
+        { result.score } -> std::convertible_to<double>;
+    };
+
+    enum class NmsMode
+    {
+        Suppress, // drop the results overlapping a better one
+        Merge,    // also grow the better one to the bounding rect of the results it absorbed
+    };
+
+    // default grouping of non_max_suppress: any two results may suppress each other
+    struct NmsAnyGroup
+    {
+        template <typename ResultT>
+        constexpr bool operator()(const ResultT&, const ResultT&) const noexcept
+        {
+            return true;
+        }
+    };
+
+    // Non-maximum suppression, in place.
+    // Results are taken from the highest score down (the first one on ties); a result is dropped if its IoU
+    // with an already kept result of the same group is above iou_threshold. In Merge mode it is absorbed by the
+    // best scored of those. The kept results end up sorted by
+    // descending score. Kept results are registered in a uniform grid of cells as large as the largest rect,
+    // so a candidate is only compared with the results around it and the whole pass is O(n log n) for the
+    // dense, similarly sized hits template matching produces. Elements are only moved, never copied.
+    //
+    // Returns how many results were removed. Pass e.g. a comparison of TextRect::text as same_group to keep
+    // overlapping results with different text.
+    template <ScoredRect ResultT, typename SameGroupT = NmsAnyGroup>
+    size_t non_max_suppress(std::vector<ResultT>& results, double iou_threshold, NmsMode mode = NmsMode::Suppress,
+                            SameGroupT same_group = {})
+    {
+        constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+        const size_t count = results.size();
+        if (count < 2) {
+            return 0;
+        }
+
+        std::vector<uint32_t> order(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+        std::ranges::sort(order, [&](uint32_t lhs, uint32_t rhs) {
+            const double lhs_score = results[lhs].score;
+            const double rhs_score = results[rhs].score;
+            return lhs_score > rhs_score || (lhs_score == rhs_score && lhs < rhs);
+        });
+
+        int min_x = std::numeric_limits<int>::max();
+        int min_y = std::numeric_limits<int>::max();
+        int max_x = std::numeric_limits<int>::min();
+        int max_y = std::numeric_limits<int>::min();
+        int cell_size = 1;
+        for (const ResultT& result : results) {
+            const Rect& rect = result.rect;
+            min_x = std::min(min_x, rect.x);
+            min_y = std::min(min_y, rect.y);
+            max_x = std::max(max_x, rect.x + std::max(rect.width, 0));
+            max_y = std::max(max_y, rect.y + std::max(rect.height, 0));
+            cell_size = std::max({ cell_size, rect.width, rect.height });
+        }
+        // small rects spread over a large area would need too many cells
+        const int64_t max_cells = std::max<int64_t>(static_cast<int64_t>(count) * 4, 1024);
+        int64_t cols = 0;
+        int64_t rows = 0;
+        while (true) {
+            cols = (static_cast<int64_t>(max_x) - min_x) / cell_size + 1;
+            rows = (static_cast<int64_t>(max_y) - min_y) / cell_size + 1;
+            if (cols * rows <= max_cells || cell_size > std::numeric_limits<int>::max() / 2) {
+                break;
+            }
+            cell_size *= 2;
+        }
+        auto cell_range = [&](const Rect& rect) {
+            const int64_t first_col = (static_cast<int64_t>(rect.x) - min_x) / cell_size;
+            const int64_t first_row = (static_cast<int64_t>(rect.y) - min_y) / cell_size;
+            const int64_t last_col = (static_cast<int64_t>(rect.x) + std::max(rect.width, 0) - min_x) / cell_size;
+            const int64_t last_row = (static_cast<int64_t>(rect.y) + std::max(rect.height, 0) - min_y) / cell_size;
+            return std::array<int64_t, 4> { first_col, first_row, std::min(last_col, cols - 1),
+                                            std::min(last_row, rows - 1) };
+        };
+
+        // per cell, a linked list of the kept results covering it, threaded through `entries`
+        struct Entry
+        {
+            uint32_t result = 0;
+            uint32_t next = 0;
+        };
+        std::vector<uint32_t> cell_heads(static_cast<size_t>(cols * rows), None);
+        std::vector<Entry> entries;
+        entries.reserve(count);
+        // for every result the kept result it belongs to, None while undecided
+        std::vector<uint32_t> owner(count, None);
+        std::vector<uint32_t> kept;
+        // for every kept result its position in `kept`, i.e. its rank by score
+        std::vector<uint32_t> rank(count, None);
+
+        for (uint32_t index : order) {
+            const Rect& rect = results[index].rect;
+            const auto [first_col, first_row, last_col, last_row] = cell_range(rect);
+            // the owner is the best overlapping kept result, whatever the cell it is found in first; in Suppress
+            // mode any one does
+            uint32_t best_rank = None;
+            for (int64_t row = first_row; row <= last_row; ++row) {
+                for (int64_t col = first_col; col <= last_col; ++col) {
+                    for (uint32_t entry = cell_heads[row * cols + col]; entry != None; entry = entries[entry].next) {
+                        const uint32_t other = entries[entry].result;
+                        if (rank[other] < best_rank && same_group(results[other], results[index]) &&
+                            rect_iou(results[other].rect, rect) > iou_threshold) {
+                            best_rank = rank[other];
+                            owner[index] = other;
+                        }
+                    }
+                    if (owner[index] != None && mode == NmsMode::Suppress) break;
+                }
+                if (owner[index] != None && mode == NmsMode::Suppress) break;
+            }
+            if (owner[index] != None) {
+                continue;
+            }
+            owner[index] = index;
+            rank[index] = static_cast<uint32_t>(kept.size());
+            kept.emplace_back(index);
+            for (int64_t row = first_row; row <= last_row; ++row) {
+                for (int64_t col = first_col; col <= last_col; ++col) {
+                    uint32_t& head = cell_heads[row * cols + col];
+                    entries.emplace_back(Entry { index, head });
+                    head = static_cast<uint32_t>(entries.size() - 1);
+                }
+            }
+        }
+
+        if (mode == NmsMode::Merge) {
+            // the grid holds the original rects, so grow them only now
+            for (uint32_t index = 0; index < count; ++index) {
+                if (owner[index] == index) {
+                    continue;
+                }
+                Rect& target = results[owner[index]].rect;
+                const Rect& absorbed = results[index].rect;
+                const int right = std::max(target.x + target.width, absorbed.x + absorbed.width);
+                const int bottom = std::max(target.y + target.height, absorbed.y + absorbed.height);
+                target.x = std::min(target.x, absorbed.x);
+                target.y = std::min(target.y, absorbed.y);
+                target.width = right - target.x;
+                target.height = bottom - target.y;
+            }
+        }
+
+        // move the kept results to the front in score order: results[i] = old results[kept[i]],
+        // applied cycle by cycle with `order` reused as the permutation
+        const size_t kept_count = kept.size();
+        std::ranges::copy(kept, order.begin());
+        std::ranges::fill(owner, None);
+        for (uint32_t i = 0; i < kept_count; ++i) {
+            owner[kept[i]] = i;
+        }
+        size_t next_slot = kept_count;
+        for (uint32_t index = 0; index < count; ++index) {
+            if (owner[index] == None) {
+                order[next_slot++] = index;
+            }
+        }
+        for (uint32_t start = 0; start < count; ++start) {
+            if (order[start] == start) {
+                continue;
+            }
+            ResultT moving = std::move(results[start]);
+            uint32_t slot = start;
+            while (order[slot] != start) {
+                const uint32_t from = order[slot];
+                results[slot] = std::move(results[from]);
+                order[slot] = slot;
+                slot = from;
+            }
+            results[slot] = std::move(moving);
+            order[slot] = slot;
+        }
+        results.erase(results.begin() + static_cast<std::ptrdiff_t>(kept_count), results.end());
+        return count - kept_count;
+    }
+} // namespace asst
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+
+namespace asst
+{
+    namespace detail
+    {
+        // Open addressing hash table with linear probing, for small trivially hashed keys such as screen
+        // coordinates. Every slot has a control byte (0 when empty, otherwise 0x80 | 7 bits of the hash) kept
+        // apart from the slots, so a probe mostly touches one cache line of bytes and compares a key only
+        // when the bytes match. Erasing shifts the following entries back instead of leaving tombstones, so
+        // lookups never slow down after many erases.
+        //
+        // MappedT = void makes it a set. Keys and mapped values must be default constructible; any insert or
+        // erase invalidates iterators and references.
+        template <typename KeyT, typename MappedT, typename HashT = std::hash<KeyT>>
+        class OpenHashTable
+        {
+        public:
+            static constexpr bool IsSet = std::is_void_v<MappedT>;
+            using key_type = KeyT;
+            using value_type = std::conditional_t<IsSet, KeyT, std::pair<KeyT, MappedT>>;
+            using size_type = size_t;
+
+            template <bool Const>
+            class basic_iterator
+            {
+                using table_t = std::conditional_t<Const, const OpenHashTable, OpenHashTable>;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = OpenHashTable::value_type;
+                using difference_type = std::ptrdiff_t;
+                using reference = std::conditional_t<Const || IsSet, const value_type&, value_type&>;
+                using pointer = std::remove_reference_t<reference>*;
+
+                basic_iterator() = default;
+                basic_iterator(table_t* table, size_t pos) : m_table(table), m_pos(pos) { skip_empty(); }
+                // iterator -> const_iterator
+                operator basic_iterator<true>() const { return { m_table, m_pos }; }
+
+                reference operator*() const { return m_table->m_slots[m_pos]; }
+                pointer operator->() const { return &m_table->m_slots[m_pos]; }
+                basic_iterator& operator++()
+                {
+                    ++m_pos;
+                    skip_empty();
+                    return *this;
+                }
+                basic_iterator operator++(int)
+                {
+                    basic_iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+                bool operator==(const basic_iterator& rhs) const noexcept { return m_pos == rhs.m_pos; }
+
+            private:
+                friend class OpenHashTable;
+
+                void skip_empty()
+                {
+                    while (m_pos < m_table->m_ctrl.size() && m_table->m_ctrl[m_pos] == Empty) {
+                        ++m_pos;
+                    }
+                }
+
+                table_t* m_table = nullptr;
+                size_t m_pos = 0;
+            };
+            using iterator = basic_iterator<false>;
+            using const_iterator = basic_iterator<true>;
+
+            OpenHashTable() = default;
+            explicit OpenHashTable(size_t expected) { reserve(expected); }
+
+            iterator begin() noexcept { return { this, 0 }; }
+            iterator end() noexcept { return { this, m_ctrl.size() }; }
+            const_iterator begin() const noexcept { return { this, 0 }; }
+            const_iterator end() const noexcept { return { this, m_ctrl.size() }; }
+
+            size_t size() const noexcept { return m_size; }
+            bool empty() const noexcept { return m_size == 0; }
+            size_t capacity() const noexcept { return m_ctrl.size(); }
+
+            void clear()
+            {
+                std::fill(m_ctrl.begin(), m_ctrl.end(), Empty);
+                std::fill(m_slots.begin(), m_slots.end(), value_type {});
+                m_size = 0;
+            }
+
+            // makes room for `expected` elements without rehashing
+            void reserve(size_t expected)
+            {
+                // max load factor 7/8
+                size_t wanted = std::bit_ceil(std::max<size_t>(expected + expected / 7 + 1, MinCapacity));
+                if (wanted > m_ctrl.size()) {
+                    rehash(wanted);
+                }
+            }
+
+            iterator find(const KeyT& key) { return { this, find_pos(key) }; }
+            const_iterator find(const KeyT& key) const { return { this, find_pos(key) }; }
+            bool contains(const KeyT& key) const { return find_pos(key) != m_ctrl.size(); }
+
+            // like std::unordered_map::try_emplace / std::unordered_set::insert
+            template <typename... ArgsT>
+            std::pair<iterator, bool> try_emplace(const KeyT& key, ArgsT&&... args)
+            {
+                reserve(m_size + 1);
+                const size_t hash = HashT()(key);
+                const uint8_t tag = tag_of(hash);
+                size_t pos = hash & mask();
+                for (; m_ctrl[pos] != Empty; pos = (pos + 1) & mask()) {
+                    if (m_ctrl[pos] == tag && key_of(m_slots[pos]) == key) {
+                        return { iterator(this, pos), false };
+                    }
+                }
+                m_ctrl[pos] = tag;
+                if constexpr (IsSet) {
+                    m_slots[pos] = key;
+                }
+                else {
+                    m_slots[pos] = value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                                              std::forward_as_tuple(std::forward<ArgsT>(args)...));
+                }
+                ++m_size;
+                return { iterator(this, pos), true };
+            }
+            std::pair<iterator, bool> insert(const value_type& value)
+            {
+                if constexpr (IsSet) {
+                    return try_emplace(value);
+                }
+                else {
+                    return try_emplace(value.first, value.second);
+                }
+            }
+            template <typename ValueT>
+            requires(!IsSet)
+            std::pair<iterator, bool> insert_or_assign(const KeyT& key, ValueT&& value)
+            {
+                auto result = try_emplace(key);
+                result.first->second = std::forward<ValueT>(value);
+                return result;
+            }
+            template <typename ValueT = MappedT>
+            requires(!IsSet)
+            ValueT& operator[](const KeyT& key)
+            {
+                return try_emplace(key).first->second;
+            }
+
+            size_t erase(const KeyT& key)
+            {
+                size_t pos = find_pos(key);
+                if (pos == m_ctrl.size()) {
+                    return 0;
+                }
+                erase_at(pos);
+                return 1;
+            }
+            void erase(const_iterator iter) { erase_at(iter.m_pos); }
+
+        private:
+            static constexpr uint8_t Empty = 0;
+            static constexpr size_t MinCapacity = 16;
+
+            static uint8_t tag_of(size_t hash) noexcept
+            {
+                // the low bits pick the slot, the tag comes from the high ones
+                return static_cast<uint8_t>(0x80 | (hash >> (sizeof(size_t) * 8 - 7)));
+            }
+            static const KeyT& key_of(const value_type& value) noexcept
+            {
+                if constexpr (IsSet) {
+                    return value;
+                }
+                else {
+                    return value.first;
+                }
+            }
+            size_t mask() const noexcept { return m_ctrl.size() - 1; }
+
+            size_t find_pos(const KeyT& key) const
+            {
+                if (m_size == 0) {
+                    return m_ctrl.size();
+                }
+                const size_t hash = HashT()(key);
+                const uint8_t tag = tag_of(hash);
+                for (size_t pos = hash & mask(); m_ctrl[pos] != Empty; pos = (pos + 1) & mask()) {
+                    if (m_ctrl[pos] == tag && key_of(m_slots[pos]) == key) {
+                        return pos;
+                    }
+                }
+                return m_ctrl.size();
+            }
+
+            void erase_at(size_t hole)
+            {
+                // backward shift: move every following entry that may live in the hole into it
+                for (size_t pos = (hole + 1) & mask(); m_ctrl[pos] != Empty; pos = (pos + 1) & mask()) {
+                    const size_t home = HashT()(key_of(m_slots[pos])) & mask();
+                    // distance from home to pos vs from home to hole, both along the probe sequence
+                    if (((pos - home) & mask()) >= ((pos - hole) & mask())) {
+                        m_ctrl[hole] = m_ctrl[pos];
+                        m_slots[hole] = std::move(m_slots[pos]);
+                        hole = pos;
+                    }
+                }
+                m_ctrl[hole] = Empty;
+                m_slots[hole] = value_type {};
+                --m_size;
+            }
+
+            void rehash(size_t capacity)
+            {
+                std::vector<uint8_t> old_ctrl(capacity, Empty);
+                std::vector<value_type> old_slots(capacity);
+                old_ctrl.swap(m_ctrl);
+                old_slots.swap(m_slots);
+                for (size_t i = 0; i < old_ctrl.size(); ++i) {
+                    if (old_ctrl[i] == Empty) {
+                        continue;
+                    }
+                    size_t pos = HashT()(key_of(old_slots[i])) & mask();
+                    while (m_ctrl[pos] != Empty) {
+                        pos = (pos + 1) & mask();
+                    }
+                    m_ctrl[pos] = old_ctrl[i];
+                    m_slots[pos] = std::move(old_slots[i]);
+                }
+            }
+
+            std::vector<uint8_t> m_ctrl;
+            std::vector<value_type> m_slots;
+            size_t m_size = 0;
+        };
+    } // namespace detail
+
+    // Hash containers for dense screen coordinate workloads (visited points, deduplicated match rects, ...),
+    // faster than std::unordered_map / std::unordered_set for these keys since there is no node allocation.
+    template <typename MappedT>
+    using PointMap = detail::OpenHashTable<Point, MappedT>;
+    using PointSet = detail::OpenHashTable<Point, void>;
+    template <typename MappedT>
+    using RectMap = detail::OpenHashTable<Rect, MappedT>;
+    using RectSet = detail::OpenHashTable<Rect, void>;
+} // namespace asst
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+
+#if !defined(ASST_DISABLE_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#if defined(__GNUC__) || defined(__clang__)
+// compile the SSE4.1 / AVX2 kernels per function, the CPU picks one at runtime
+#define ASST_SIMD_TARGET(isa) __attribute__((target(isa)))
+#define ASST_RECT_BATCH_SIMD
+#elif defined(_MSC_VER)
+#define ASST_SIMD_TARGET(isa)
+#define ASST_RECT_BATCH_SIMD
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef ASST_RECT_BATCH_SIMD
+#include <immintrin.h>
+#endif
+
+namespace asst
+{
+    // Rects stored as structure of arrays, so that the batch kernels below can load 4 or 8 of each coordinate at
+    // once. Build one from the candidates of a recognition, then run the kernels over all of them.
+    struct RectBatch
+    {
+        RectBatch() = default;
+        explicit RectBatch(std::span<const Rect> rects)
+        {
+            reserve(rects.size());
+            for (const Rect& rect : rects) {
+                push_back(rect);
+            }
+        }
+
+        size_t size() const noexcept { return x.size(); }
+        bool empty() const noexcept { return x.empty(); }
+        Rect operator[](size_t i) const { return { x[i], y[i], width[i], height[i] }; }
+        void push_back(const Rect& rect)
+        {
+            x.emplace_back(rect.x);
+            y.emplace_back(rect.y);
+            width.emplace_back(rect.width);
+            height.emplace_back(rect.height);
+        }
+        void reserve(size_t count)
+        {
+            x.reserve(count);
+            y.reserve(count);
+            width.reserve(count);
+            height.reserve(count);
+        }
+        void clear() noexcept
+        {
+            x.clear();
+            y.clear();
+            width.clear();
+            height.clear();
+        }
+
+        std::vector<int32_t> x;
+        std::vector<int32_t> y;
+        std::vector<int32_t> width;
+        std::vector<int32_t> height;
+    };
+
+    struct PointBatch
+    {
+        PointBatch() = default;
+        explicit PointBatch(std::span<const Point> points)
+        {
+            x.reserve(points.size());
+            y.reserve(points.size());
+            for (const Point& point : points) {
+                push_back(point);
+            }
+        }
+
+        size_t size() const noexcept { return x.size(); }
+        bool empty() const noexcept { return x.empty(); }
+        Point operator[](size_t i) const { return { x[i], y[i] }; }
+        void push_back(const Point& point)
+        {
+            x.emplace_back(point.x);
+            y.emplace_back(point.y);
+        }
+
+        std::vector<int32_t> x;
+        std::vector<int32_t> y;
+    };
+
+    // Batch versions of Rect::include, intersection over union and nearest point search.
+    // Every kernel has a scalar implementation and SSE4.1 / AVX2 ones that give exactly the same results; the
+    // widest one the CPU supports is used (define ASST_DISABLE_SIMD to always use the scalar ones).
+    namespace rect_batch
+    {
+        struct NearestResult
+        {
+            size_t index = 0;
+            int64_t squared_distance = std::numeric_limits<int64_t>::max();
+        };
+
+        namespace scalar
+        {
+            inline void include_rects(const RectBatch& rects, size_t begin, const Rect& outer, uint8_t* out)
+            {
+                for (size_t i = begin; i < rects.size(); ++i) {
+                    out[i] = outer.x <= rects.x[i] && outer.y <= rects.y[i] &&
+                             outer.x + outer.width >= rects.x[i] + rects.width[i] &&
+                             outer.y + outer.height >= rects.y[i] + rects.height[i];
+                }
+            }
+
+            inline void include_point(const RectBatch& rects, size_t begin, const Point& point, uint8_t* out)
+            {
+                for (size_t i = begin; i < rects.size(); ++i) {
+                    out[i] = rects.x[i] <= point.x && rects.y[i] <= point.y &&
+                             rects.x[i] + rects.width[i] >= point.x && rects.y[i] + rects.height[i] >= point.y;
+                }
+            }
+
+            inline float iou_at(const RectBatch& rects, size_t i, const Rect& target)
+            {
+                const int32_t inter_width =
+                    std::max(std::min(rects.x[i] + rects.width[i], target.x + target.width) -
+                                 std::max(rects.x[i], target.x),
+                             0);
+                const int32_t inter_height =
+                    std::max(std::min(rects.y[i] + rects.height[i], target.y + target.height) -
+                                 std::max(rects.y[i], target.y),
+                             0);
+                const float inter = static_cast<float>(inter_width) * static_cast<float>(inter_height);
+                const float area = static_cast<float>(rects.width[i]) * static_cast<float>(rects.height[i]);
+                const float target_area = static_cast<float>(target.width) * static_cast<float>(target.height);
+                const float united = area + target_area - inter;
+                return united > 0 ? inter / united : 0;
+            }
+
+            inline void iou(const RectBatch& rects, size_t begin, const Rect& target, float* out)
+            {
+                for (size_t i = begin; i < rects.size(); ++i) {
+                    out[i] = iou_at(rects, i, target);
+                }
+            }
+
+            inline size_t suppress(const RectBatch& rects, size_t begin, const Rect& target, float threshold,
+                                   uint8_t* suppressed)
+            {
+                size_t count = 0;
+                for (size_t i = begin; i < rects.size(); ++i) {
+                    if (!suppressed[i] && iou_at(rects, i, target) > threshold) {
+                        suppressed[i] = 1;
+                        ++count;
+                    }
+                }
+                return count;
+            }
+
+            inline NearestResult nearest(const PointBatch& points, size_t begin, const Point& target,
+                                         NearestResult best = {})
+            {
+                for (size_t i = begin; i < points.size(); ++i) {
+                    const int64_t dx = static_cast<int64_t>(points.x[i]) - target.x;
+                    const int64_t dy = static_cast<int64_t>(points.y[i]) - target.y;
+                    const int64_t dist = dx * dx + dy * dy;
+                    if (dist < best.squared_distance) {
+                        best = { i, dist };
+                    }
+                }
+                return best;
+            }
+        } // namespace scalar
+
+#ifdef ASST_RECT_BATCH_SIMD
+        // The SIMD kernels are generated for both widths from one body, `simd` provides the width specific
+        // operations. Distances are computed in double, exact while coordinates differ by less than 2^26.
+#define ASST_RECT_BATCH_DEFINE_KERNELS(simd, isa)                                                                 \
+    namespace simd                                                                                                \
+    {                                                                                                             \
+        ASST_SIMD_TARGET(isa) inline void include_rects(const RectBatch& rects, const Rect& outer, uint8_t* out)  \
+        {                                                                                                         \
+            const auto ox = set1(outer.x), oy = set1(outer.y);                                                    \
+            const auto ox2 = set1(outer.x + outer.width), oy2 = set1(outer.y + outer.height);                    \
+            size_t i = 0;                                                                                         \
+            for (; i + Lanes <= rects.size(); i += Lanes) {                                                       \
+                const auto x = load(&rects.x[i]), y = load(&rects.y[i]);                                          \
+                const auto x2 = add(x, load(&rects.width[i])), y2 = add(y, load(&rects.height[i]));               \
+                const auto outside = bit_or(bit_or(gt(ox, x), gt(oy, y)), bit_or(gt(x2, ox2), gt(y2, oy2)));      \
+                store_mask(out + i, ~movemask(outside));                                                          \
+            }                                                                                                     \
+            scalar::include_rects(rects, i, outer, out);                                                          \
+        }                                                                                                         \
+                                                                                                                  \
+        ASST_SIMD_TARGET(isa) inline void include_point(const RectBatch& rects, const Point& point, uint8_t* out) \
+        {                                                                                                         \
+            const auto px = set1(point.x), py = set1(point.y);                                                    \
+            size_t i = 0;                                                                                         \
+            for (; i + Lanes <= rects.size(); i += Lanes) {                                                       \
+                const auto x = load(&rects.x[i]), y = load(&rects.y[i]);                                          \
+                const auto x2 = add(x, load(&rects.width[i])), y2 = add(y, load(&rects.height[i]));               \
+                const auto outside = bit_or(bit_or(gt(x, px), gt(y, py)), bit_or(gt(px, x2), gt(py, y2)));       \
+                store_mask(out + i, ~movemask(outside));                                                          \
+            }                                                                                                     \
+            scalar::include_point(rects, i, point, out);                                                          \
+        }                                                                                                         \
+                                                                                                                  \
+        ASST_SIMD_TARGET(isa) inline auto iou_at(const RectBatch& rects, size_t i, const Rect& target)            \
+        {                                                                                                         \
+            const auto x = load(&rects.x[i]), y = load(&rects.y[i]);                                              \
+            const auto w = load(&rects.width[i]), h = load(&rects.height[i]);                                     \
+            const auto inter_width = max(sub(min(add(x, w), set1(target.x + target.width)),                       \
+                                             max(x, set1(target.x))),                                             \
+                                         set1(0));                                                                \
+            const auto inter_height = max(sub(min(add(y, h), set1(target.y + target.height)),                     \
+                                              max(y, set1(target.y))),                                            \
+                                          set1(0));                                                               \
+            const auto inter = mul_ps(to_ps(inter_width), to_ps(inter_height));                                   \
+            const auto target_area =                                                                              \
+                set1_ps(static_cast<float>(target.width) * static_cast<float>(target.height));                   \
+            const auto united = sub_ps(add_ps(mul_ps(to_ps(w), to_ps(h)), target_area), inter);                   \
+            return and_ps(gt_ps(united, set1_ps(0)), div_ps(inter, united));                                      \
+        }                                                                                                         \
+                                                                                                                  \
+        ASST_SIMD_TARGET(isa) inline void iou(const RectBatch& rects, const Rect& target, float* out)             \
+        {                                                                                                         \
+            size_t i = 0;                                                                                         \
+            for (; i + Lanes <= rects.size(); i += Lanes) {                                                       \
+                store_ps(out + i, iou_at(rects, i, target));                                                      \
+            }                                                                                                     \
+            scalar::iou(rects, i, target, out);                                                                   \
+        }                                                                                                         \
+                                                                                                                  \
+        ASST_SIMD_TARGET(isa) inline size_t suppress(const RectBatch& rects, size_t begin, const Rect& target,    \
+                                                     float threshold, uint8_t* suppressed)                        \
+        {                                                                                                         \
+            size_t count = 0;                                                                                     \
+            size_t i = begin;                                                                                     \
+            for (; i + Lanes <= rects.size(); i += Lanes) {                                                       \
+                int bits = movemask_ps(gt_ps(iou_at(rects, i, target), set1_ps(threshold)));                      \
+                for (; bits; bits &= bits - 1) {                                                                  \
+                    uint8_t& flag = suppressed[i + std::countr_zero(static_cast<unsigned>(bits))];                \
+                    count += !flag;                                                                               \
+                    flag = 1;                                                                                     \
+                }                                                                                                 \
+            }                                                                                                     \
+            return count + scalar::suppress(rects, i, target, threshold, suppressed);                             \
+        }                                                                                                         \
+                                                                                                                  \
+        ASST_SIMD_TARGET(isa) inline NearestResult nearest(const PointBatch& points, const Point& target)         \
+        {                                                                                                         \
+            const auto tx = set1_pd(target.x), ty = set1_pd(target.y);                                           \
+            auto best = set1_pd(std::numeric_limits<double>::infinity());                                         \
+            auto best_index = set1_pd(0);                                                                         \
+            auto index = iota_pd();                                                                               \
+            const auto step = set1_pd(static_cast<double>(LanesPd));                                              \
+            size_t i = 0;                                                                                         \
+            for (; i + LanesPd <= points.size(); i += LanesPd) {                                                  \
+                const auto dx = sub_pd(load_pd(&points.x[i]), tx), dy = sub_pd(load_pd(&points.y[i]), ty);       \
+                const auto dist = add_pd(mul_pd(dx, dx), mul_pd(dy, dy));                                         \
+                const auto closer = lt_pd(dist, best);                                                            \
+                best = blend_pd(best, dist, closer);                                                              \
+                best_index = blend_pd(best_index, index, closer);                                                 \
+                index = add_pd(index, step);                                                                      \
+            }                                                                                                     \
+            alignas(32) double dists[LanesPd];                                                                    \
+            alignas(32) double indexes[LanesPd];                                                                  \
+            store_pd(dists, best);                                                                                \
+            store_pd(indexes, best_index);                                                                        \
+            NearestResult result;                                                                                 \
+            for (size_t lane = 0; lane < LanesPd; ++lane) {                                                       \
+                const auto dist = static_cast<int64_t>(dists[lane]);                                              \
+                const auto lane_index = static_cast<size_t>(indexes[lane]);                                       \
+                if (dists[lane] != std::numeric_limits<double>::infinity() &&                                     \
+                    (dist < result.squared_distance ||                                                            \
+                     (dist == result.squared_distance && lane_index < result.index))) {                           \
+                    result = { lane_index, dist };                                                                \
+                }                                                                                                 \
+            }                                                                                                     \
+            return scalar::nearest(points, i, target, result);                                                    \
+        }                                                                                                         \
+    }
+
+        namespace sse41
+        {
+#define ASST_SSE41 ASST_SIMD_TARGET("sse4.1") inline
+            inline constexpr size_t Lanes = 4;
+            inline constexpr size_t LanesPd = 2;
+            ASST_SSE41 __m128i set1(int32_t v) { return _mm_set1_epi32(v); }
+            ASST_SSE41 __m128i load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+            ASST_SSE41 __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+            ASST_SSE41 __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+            ASST_SSE41 __m128i min(__m128i a, __m128i b) { return _mm_min_epi32(a, b); }
+            ASST_SSE41 __m128i max(__m128i a, __m128i b) { return _mm_max_epi32(a, b); }
+            ASST_SSE41 __m128i gt(__m128i a, __m128i b) { return _mm_cmpgt_epi32(a, b); }
+            ASST_SSE41 __m128i bit_or(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+            ASST_SSE41 int movemask(__m128i a) { return _mm_movemask_ps(_mm_castsi128_ps(a)); }
+            ASST_SSE41 __m128 to_ps(__m128i a) { return _mm_cvtepi32_ps(a); }
+            ASST_SSE41 __m128 set1_ps(float v) { return _mm_set1_ps(v); }
+            ASST_SSE41 __m128 add_ps(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+            ASST_SSE41 __m128 sub_ps(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+            ASST_SSE41 __m128 mul_ps(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+            ASST_SSE41 __m128 div_ps(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+            ASST_SSE41 __m128 and_ps(__m128 a, __m128 b) { return _mm_and_ps(a, b); }
+            ASST_SSE41 __m128 gt_ps(__m128 a, __m128 b) { return _mm_cmpgt_ps(a, b); }
+            ASST_SSE41 int movemask_ps(__m128 a) { return _mm_movemask_ps(a); }
+            ASST_SSE41 void store_ps(float* p, __m128 a) { _mm_storeu_ps(p, a); }
+            ASST_SSE41 __m128d set1_pd(double v) { return _mm_set1_pd(v); }
+            ASST_SSE41 __m128d iota_pd() { return _mm_set_pd(1, 0); }
+            ASST_SSE41 __m128d load_pd(const int32_t* p)
+            {
+                return _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+            }
+            ASST_SSE41 __m128d add_pd(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+            ASST_SSE41 __m128d sub_pd(__m128d a, __m128d b) { return _mm_sub_pd(a, b); }
+            ASST_SSE41 __m128d mul_pd(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+            ASST_SSE41 __m128d lt_pd(__m128d a, __m128d b) { return _mm_cmplt_pd(a, b); }
+            ASST_SSE41 __m128d blend_pd(__m128d a, __m128d b, __m128d mask) { return _mm_blendv_pd(a, b, mask); }
+            ASST_SSE41 void store_pd(double* p, __m128d a) { _mm_store_pd(p, a); }
+            inline void store_mask(uint8_t* out, int bits)
+            {
+                for (size_t lane = 0; lane < Lanes; ++lane) {
+                    out[lane] = (bits >> lane) & 1;
+                }
+            }
+#undef ASST_SSE41
+        } // namespace sse41
+        ASST_RECT_BATCH_DEFINE_KERNELS(sse41, "sse4.1")
+
+        namespace avx2
+        {
+#define ASST_AVX2 ASST_SIMD_TARGET("avx2") inline
+            inline constexpr size_t Lanes = 8;
+            inline constexpr size_t LanesPd = 4;
+            ASST_AVX2 __m256i set1(int32_t v) { return _mm256_set1_epi32(v); }
+            ASST_AVX2 __m256i load(const int32_t* p)
+            {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            }
+            ASST_AVX2 __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+            ASST_AVX2 __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+            ASST_AVX2 __m256i min(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+            ASST_AVX2 __m256i max(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+            ASST_AVX2 __m256i gt(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+            ASST_AVX2 __m256i bit_or(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+            ASST_AVX2 int movemask(__m256i a) { return _mm256_movemask_ps(_mm256_castsi256_ps(a)); }
+            ASST_AVX2 __m256 to_ps(__m256i a) { return _mm256_cvtepi32_ps(a); }
+            ASST_AVX2 __m256 set1_ps(float v) { return _mm256_set1_ps(v); }
+            ASST_AVX2 __m256 add_ps(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+            ASST_AVX2 __m256 sub_ps(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+            ASST_AVX2 __m256 mul_ps(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+            ASST_AVX2 __m256 div_ps(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+            ASST_AVX2 __m256 and_ps(__m256 a, __m256 b) { return _mm256_and_ps(a, b); }
+            ASST_AVX2 __m256 gt_ps(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+            ASST_AVX2 int movemask_ps(__m256 a) { return _mm256_movemask_ps(a); }
+            ASST_AVX2 void store_ps(float* p, __m256 a) { _mm256_storeu_ps(p, a); }
+            ASST_AVX2 __m256d set1_pd(double v) { return _mm256_set1_pd(v); }
+            ASST_AVX2 __m256d iota_pd() { return _mm256_set_pd(3, 2, 1, 0); }
+            ASST_AVX2 __m256d load_pd(const int32_t* p)
+            {
+                return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            }
+            ASST_AVX2 __m256d add_pd(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+            ASST_AVX2 __m256d sub_pd(__m256d a, __m256d b) { return _mm256_sub_pd(a, b); }
+            ASST_AVX2 __m256d mul_pd(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+            ASST_AVX2 __m256d lt_pd(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+            ASST_AVX2 __m256d blend_pd(__m256d a, __m256d b, __m256d mask) { return _mm256_blendv_pd(a, b, mask); }
+            ASST_AVX2 void store_pd(double* p, __m256d a) { _mm256_store_pd(p, a); }
+            inline void store_mask(uint8_t* out, int bits)
+            {
+                for (size_t lane = 0; lane < Lanes; ++lane) {
+                    out[lane] = (bits >> lane) & 1;
+                }
+            }
+#undef ASST_AVX2
+        } // namespace avx2
+        ASST_RECT_BATCH_DEFINE_KERNELS(avx2, "avx2")
+
+#undef ASST_RECT_BATCH_DEFINE_KERNELS
+#endif // ASST_RECT_BATCH_SIMD
+
+        enum class Isa
+        {
+            Scalar,
+            SSE41,
+            AVX2,
+        };
+
+        inline Isa detect_isa()
+        {
+#ifdef ASST_RECT_BATCH_SIMD
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return Isa::AVX2;
+            }
+            if (__builtin_cpu_supports("sse4.1")) {
+                return Isa::SSE41;
+            }
+#else
+            int info[4] = {};
+            __cpuid(info, 0);
+            const int max_leaf = info[0];
+            __cpuid(info, 1);
+            const bool sse41 = (info[2] & (1 << 19)) != 0;
+            // the OS must save the ymm registers on context switch
+            const bool os_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            if (max_leaf >= 7 && os_ymm) {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5)) {
+                    return Isa::AVX2;
+                }
+            }
+            if (sse41) {
+                return Isa::SSE41;
+            }
+#endif
+#endif
+            return Isa::Scalar;
+        }
+
+        inline Isa isa()
+        {
+            static const Isa detected = detect_isa();
+            return detected;
+        }
+
+#ifdef ASST_RECT_BATCH_SIMD
+#define ASST_RECT_BATCH_DISPATCH(call, scalar_call) \
+    switch (isa()) {                                \
+    case Isa::AVX2:                                 \
+        return avx2::call;                          \
+    case Isa::SSE41:                                \
+        return sse41::call;                         \
+    default:                                        \
+        return scalar::scalar_call;                 \
+    }
+#else
+#define ASST_RECT_BATCH_DISPATCH(call, scalar_call) return scalar::scalar_call;
+#endif
+
+        // out[i] = outer.include(rects[i]), `out` holds rects.size() elements
+        inline void include(const RectBatch& rects, const Rect& outer, std::span<uint8_t> out)
+        {
+            ASST_RECT_BATCH_DISPATCH(include_rects(rects, outer, out.data()),
+                                     include_rects(rects, 0, outer, out.data()))
+        }
+
+        // out[i] = rects[i].include(point)
+        inline void include(const RectBatch& rects, const Point& point, std::span<uint8_t> out)
+        {
+            ASST_RECT_BATCH_DISPATCH(include_point(rects, point, out.data()),
+                                     include_point(rects, 0, point, out.data()))
+        }
+
+        // out[i] = intersection over union of rects[i] and target, 0 when both are empty
+        inline void iou(const RectBatch& rects, const Rect& target, std::span<float> out)
+        {
+            ASST_RECT_BATCH_DISPATCH(iou(rects, target, out.data()), iou(rects, 0, target, out.data()))
+        }
+
+        // One step of non-maximum suppression: sets suppressed[i] for every i >= begin whose IoU with target is
+        // above threshold, and returns how many were not suppressed before.
+        inline size_t suppress(const RectBatch& rects, size_t begin, const Rect& target, float threshold,
+                               std::span<uint8_t> suppressed)
+        {
+            ASST_RECT_BATCH_DISPATCH(suppress(rects, begin, target, threshold, suppressed.data()),
+                                     suppress(rects, begin, target, threshold, suppressed.data()))
+        }
+
+        // the point closest to target, the first one on ties; squared_distance is INT64_MAX when points is empty
+        inline NearestResult nearest(const PointBatch& points, const Point& target)
+        {
+            ASST_RECT_BATCH_DISPATCH(nearest(points, target), nearest(points, 0, target))
+        }
+
+#undef ASST_RECT_BATCH_DISPATCH
+    } // namespace rect_batch
+} // namespace asst
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+
+namespace asst
+{
+    // dense index of an interned task name, valid for the TaskRegistry that returned it
+    using TaskIndex = uint32_t;
+    inline constexpr TaskIndex InvalidTaskIndex = std::numeric_limits<TaskIndex>::max();
+
+    enum class TaskEdge
+    {
+        Sub,
+        Next,
+        ExceededNext,
+        OnErrorNext,
+        ReduceOtherTimes,
+        Count,
+    };
+
+    // Task graph with interned names.
+    // Every task name gets a dense index: defined tasks first, in the order given to build(), then the names
+    // that are only referenced by other tasks. The sub / next / exceeded_next / on_error_next /
+    // reduce_other_times lists are stored as indexes in one CSR array, so following the graph is plain
+    // array indexing instead of hashing a string at every hop.
+    class TaskRegistry
+    {
+    public:
+        TaskRegistry() = default;
+        TaskRegistry(const TaskRegistry&) = delete;
+        TaskRegistry(TaskRegistry&&) noexcept = default;
+        TaskRegistry& operator=(const TaskRegistry&) = delete;
+        TaskRegistry& operator=(TaskRegistry&&) noexcept = default;
+
+        // Elements may be TaskInfo objects or (smart) pointers to them. Replaces the previous content.
+        template <typename TaskRangeT>
+        void build(const TaskRangeT& tasks);
+
+        TaskIndex find(std::string_view name) const
+        {
+            auto iter = m_indexes.find(name);
+            return iter == m_indexes.end() ? InvalidTaskIndex : iter->second;
+        }
+        const std::string& name(TaskIndex index) const { return *m_names[index]; }
+        // number of interned names, defined or not
+        size_t size() const noexcept { return m_names.size(); }
+        // whether build() got a definition for this task, or it is only referenced
+        bool defined(TaskIndex index) const noexcept { return index < m_defined_count; }
+        size_t defined_count() const noexcept { return m_defined_count; }
+
+        std::span<const TaskIndex> edges(TaskIndex index, TaskEdge edge) const
+        {
+            if (!defined(index)) {
+                return {};
+            }
+            const size_t slot = static_cast<size_t>(index) * EdgeCount + static_cast<size_t>(edge);
+            return { m_targets.data() + m_offsets[slot], m_targets.data() + m_offsets[slot + 1] };
+        }
+        std::span<const TaskIndex> sub(TaskIndex index) const { return edges(index, TaskEdge::Sub); }
+        std::span<const TaskIndex> next(TaskIndex index) const { return edges(index, TaskEdge::Next); }
+        std::span<const TaskIndex> exceeded_next(TaskIndex index) const
+        {
+            return edges(index, TaskEdge::ExceededNext);
+        }
+        std::span<const TaskIndex> on_error_next(TaskIndex index) const
+        {
+            return edges(index, TaskEdge::OnErrorNext);
+        }
+        std::span<const TaskIndex> reduce_other_times(TaskIndex index) const
+        {
+            return edges(index, TaskEdge::ReduceOtherTimes);
+        }
+
+    private:
+        static constexpr size_t EdgeCount = static_cast<size_t>(TaskEdge::Count);
+
+        struct NameHash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view name) const noexcept { return std::hash<std::string_view>()(name); }
+        };
+
+        template <typename TaskT>
+        static const TaskInfo& deref(const TaskT& task)
+        {
+            if constexpr (std::derived_from<TaskT, TaskInfo>) {
+                return task;
+            }
+            else {
+                return *task;
+            }
+        }
+
+        TaskIndex intern(std::string_view name)
+        {
+            auto [iter, inserted] = m_indexes.try_emplace(std::string(name), static_cast<TaskIndex>(m_names.size()));
+            if (inserted) {
+                // keys of a node-based map never move
+                m_names.emplace_back(&iter->first);
+            }
+            return iter->second;
+        }
+
+        std::unordered_map<std::string, TaskIndex, NameHash, std::equal_to<>> m_indexes;
+        std::vector<const std::string*> m_names;
+        size_t m_defined_count = 0;
+        // edges of task i and kind k are m_targets[m_offsets[i * EdgeCount + k], m_offsets[i * EdgeCount + k + 1])
+        std::vector<uint32_t> m_offsets;
+        std::vector<TaskIndex> m_targets;
+    };
+
+    template <typename TaskRangeT>
+    inline void TaskRegistry::build(const TaskRangeT& tasks)
+    {
+        m_indexes.clear();
+        m_names.clear();
+        m_offsets.clear();
+        m_targets.clear();
+
+        // names of defined tasks come first, so that `defined` is a single comparison
+        for (const auto& task : tasks) {
+            intern(deref(task).name);
+        }
+        m_defined_count = m_names.size();
+
+        size_t edge_total = 0;
+        for (const auto& task : tasks) {
+            const TaskInfo& info = deref(task);
+            edge_total += info.sub.size() + info.next.size() + info.exceeded_next.size() +
+                          info.on_error_next.size() + info.reduce_other_times.size();
+        }
+        m_offsets.assign(m_defined_count * EdgeCount + 1, 0);
+        m_targets.reserve(edge_total);
+
+        // a name defined twice keeps the edges of its last definition
+        std::vector<const TaskInfo*> definitions(m_defined_count, nullptr);
+        for (const auto& task : tasks) {
+            const TaskInfo& info = deref(task);
+            definitions[find(info.name)] = &info;
+        }
+
+        for (size_t index = 0; index < m_defined_count; ++index) {
+            const TaskInfo& info = *definitions[index];
+            const std::array<const std::vector<std::string>*, EdgeCount> lists = {
+                &info.sub, &info.next, &info.exceeded_next, &info.on_error_next, &info.reduce_other_times,
+            };
+            for (size_t edge = 0; edge < EdgeCount; ++edge) {
+                const size_t slot = index * EdgeCount + edge;
+                m_offsets[slot] = static_cast<uint32_t>(m_targets.size());
+                for (const std::string& target : *lists[edge]) {
+                    m_targets.emplace_back(intern(target));
+                }
+            }
+        }
+        m_offsets.back() = static_cast<uint32_t>(m_targets.size());
+    }
+} // namespace asst
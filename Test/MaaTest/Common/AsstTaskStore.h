@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common/AsstTaskTable.h"
+#include "Utils/Logger.hpp"
+#include "Utils/Platform.hpp"
+#include "Utils/WorkingDir.hpp"
+
+namespace asst
+{
+    // Immutable set of tasks. A reader keeps the snapshot it got alive for as long as it uses it, reloads only
+    // ever publish new snapshots.
+    struct TaskSnapshot
+    {
+        struct Entry
+        {
+            const TaskTable* table = nullptr;
+            size_t pos = 0;
+        };
+        struct NameHash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view name) const noexcept { return std::hash<std::string_view>()(name); }
+        };
+
+        // one table per json file, shared with the previous snapshot while the file is unchanged
+        std::map<std::filesystem::path, std::shared_ptr<const TaskTable>> files;
+        // a task defined in several files comes from the last one in path order
+        std::unordered_map<std::string, Entry, NameHash, std::equal_to<>> index;
+
+        const TaskInfo* find(std::string_view name) const
+        {
+            auto iter = index.find(name);
+            return iter == index.end() ? nullptr : &iter->second.table->base(iter->second.pos);
+        }
+    };
+
+    struct TaskDiff
+    {
+        std::vector<std::string> added;
+        std::vector<std::string> removed;
+        std::vector<std::string> modified;
+
+        bool empty() const noexcept { return added.empty() && removed.empty() && modified.empty(); }
+    };
+
+    // Tasks loaded from the json files of a directory (ResDir unless given), optionally kept in sync
+    // with the files while they are edited. A reload reparses only the files that changed, diffs the tasks
+    // against the current snapshot, and publishes a new snapshot with one atomic store, so running instances
+    // are never blocked by it.
+    class TaskStore
+    {
+    public:
+        using ReloadCallback = std::function<void(const TaskDiff&)>;
+
+        TaskStore() = default;
+        TaskStore(const TaskStore&) = delete;
+        TaskStore& operator=(const TaskStore&) = delete;
+        ~TaskStore() { stop_watching(); }
+
+        bool load() { return load(ResDir.get()); }
+        bool load(const std::filesystem::path& dir);
+        std::shared_ptr<const TaskSnapshot> snapshot() const;
+
+        // Reparse the given files (or everything, if the directory itself is among them) and publish the result.
+        // A file that fails to parse keeps its previous tasks.
+        TaskDiff reload(const std::vector<std::filesystem::path>& changed);
+
+        // false until a load() succeeded
+        bool start_watching(ReloadCallback on_reload = nullptr);
+        void stop_watching();
+
+    private:
+        static bool is_task_file(const std::filesystem::path& path) { return path.extension() == ".json"; }
+        static std::shared_ptr<const TaskTable> load_file(const std::filesystem::path& path);
+        static bool is_within(const std::filesystem::path& path, const std::filesystem::path& dir);
+        static void erase_tree(const std::filesystem::path& dir, TaskSnapshot& snapshot);
+        static void rescan(const std::filesystem::path& dir, const TaskSnapshot& old_snapshot,
+                           TaskSnapshot& new_snapshot, std::vector<std::filesystem::path>& files);
+        static void build_index(TaskSnapshot& snapshot);
+        static TaskDiff diff(const TaskSnapshot& old_snapshot, const TaskSnapshot& new_snapshot);
+        void publish(std::shared_ptr<const TaskSnapshot> snapshot);
+
+        std::filesystem::path m_dir;
+        // serializes writers, readers never take it
+        std::mutex m_reload_mutex;
+#ifdef __cpp_lib_atomic_shared_ptr
+        std::atomic<std::shared_ptr<const TaskSnapshot>> m_snapshot;
+#else
+        mutable std::mutex m_snapshot_mutex;
+        std::shared_ptr<const TaskSnapshot> m_snapshot;
+#endif
+        std::atomic_bool m_watch_exit = false;
+        std::thread m_watch_thread;
+    };
+
+    inline bool TaskStore::load(const std::filesystem::path& dir)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(dir, ec)) {
+            Log.error("Task dir", dir, "does not exist");
+            return false;
+        }
+        {
+            std::unique_lock<std::mutex> lock(m_reload_mutex);
+            m_dir = dir;
+        }
+        publish(std::make_shared<const TaskSnapshot>());
+        reload({ dir });
+        return true;
+    }
+
+    inline std::shared_ptr<const TaskSnapshot> TaskStore::snapshot() const
+    {
+#ifdef __cpp_lib_atomic_shared_ptr
+        return m_snapshot.load(std::memory_order_acquire);
+#else
+        std::unique_lock<std::mutex> lock(m_snapshot_mutex);
+        return m_snapshot;
+#endif
+    }
+
+    inline void TaskStore::publish(std::shared_ptr<const TaskSnapshot> snapshot)
+    {
+#ifdef __cpp_lib_atomic_shared_ptr
+        m_snapshot.store(std::move(snapshot), std::memory_order_release);
+#else
+        std::unique_lock<std::mutex> lock(m_snapshot_mutex);
+        m_snapshot = std::move(snapshot);
+#endif
+    }
+
+    inline TaskDiff TaskStore::reload(const std::vector<std::filesystem::path>& changed)
+    {
+        std::unique_lock<std::mutex> lock(m_reload_mutex);
+
+        auto old_snapshot = snapshot();
+        auto new_snapshot = std::make_shared<TaskSnapshot>();
+        new_snapshot->files = old_snapshot->files;
+
+        std::vector<std::filesystem::path> files;
+        if (std::ranges::find(changed, m_dir) != changed.end()) {
+            rescan(m_dir, *old_snapshot, *new_snapshot, files);
+        }
+        else {
+            for (const auto& path : changed) {
+                std::error_code ec;
+                if (std::filesystem::is_directory(path, ec)) {
+                    // moved in or renamed: the watcher may not report the files under it
+                    rescan(path, *old_snapshot, *new_snapshot, files);
+                }
+                else if (std::filesystem::exists(path, ec)) {
+                    if (is_task_file(path)) {
+                        files.emplace_back(path);
+                    }
+                }
+                else {
+                    // a file deleted, or a whole directory moved away
+                    erase_tree(path, *new_snapshot);
+                }
+            }
+            std::ranges::sort(files);
+            files.erase(std::unique(files.begin(), files.end()), files.end());
+        }
+
+        for (const auto& path : files) {
+            if (auto table = load_file(path)) {
+                new_snapshot->files[path] = std::move(table);
+            }
+        }
+
+        build_index(*new_snapshot);
+        TaskDiff result = diff(*old_snapshot, *new_snapshot);
+        if (!result.empty()) {
+            Log.info("Tasks reloaded,", result.added.size(), "added,", result.removed.size(), "removed,",
+                     result.modified.size(), "modified");
+        }
+        publish(std::move(new_snapshot));
+        return result;
+    }
+
+    inline bool TaskStore::start_watching(ReloadCallback on_reload)
+    {
+        stop_watching();
+
+        std::filesystem::path dir;
+        {
+            std::unique_lock<std::mutex> lock(m_reload_mutex);
+            dir = m_dir;
+        }
+        if (dir.empty()) {
+            Log.error("No task dir to watch, load() first");
+            return false;
+        }
+        platform::dir_watcher watcher(dir);
+        if (!watcher.valid()) {
+            Log.error("Failed to watch", dir);
+            return false;
+        }
+        m_watch_exit = false;
+        m_watch_thread = std::thread([this, watcher = std::move(watcher), on_reload = std::move(on_reload)]() mutable {
+            using namespace std::chrono_literals;
+            while (!m_watch_exit) {
+                auto changed = watcher.wait(200ms);
+                if (changed.empty()) {
+                    continue;
+                }
+                // editors often save in several steps, take them as one change
+                for (auto more = watcher.wait(50ms); !more.empty(); more = watcher.wait(50ms)) {
+                    changed.insert(changed.end(), more.begin(), more.end());
+                }
+                TaskDiff result = reload(changed);
+                if (on_reload && !result.empty()) {
+                    on_reload(result);
+                }
+            }
+        });
+        return true;
+    }
+
+    inline void TaskStore::stop_watching()
+    {
+        m_watch_exit = true;
+        if (m_watch_thread.joinable()) {
+            m_watch_thread.join();
+        }
+    }
+
+    // whether path is dir or lies under it, comparing whole components
+    inline bool TaskStore::is_within(const std::filesystem::path& path, const std::filesystem::path& dir)
+    {
+        return std::mismatch(dir.begin(), dir.end(), path.begin(), path.end()).first == dir.end();
+    }
+
+    inline void TaskStore::erase_tree(const std::filesystem::path& dir, TaskSnapshot& snapshot)
+    {
+        std::erase_if(snapshot.files, [&](const auto& file) { return is_within(file.first, dir); });
+    }
+
+    // Drops the files under dir that are gone and lists all others for parsing, keeping what parsed before
+    // for files that fail now.
+    inline void TaskStore::rescan(const std::filesystem::path& dir, const TaskSnapshot& old_snapshot,
+                                  TaskSnapshot& new_snapshot, std::vector<std::filesystem::path>& files)
+    {
+        erase_tree(dir, new_snapshot);
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec)) {
+            if (!entry.is_regular_file(ec) || !is_task_file(entry.path())) {
+                continue;
+            }
+            files.emplace_back(entry.path());
+            if (auto iter = old_snapshot.files.find(entry.path()); iter != old_snapshot.files.end()) {
+                new_snapshot.files.emplace(*iter);
+            }
+        }
+    }
+
+    inline std::shared_ptr<const TaskTable> TaskStore::load_file(const std::filesystem::path& path)
+    {
+        // read into a buffer rather than mapped: the file may be truncated by an editor while it is parsed,
+        // which would raise SIGBUS on a mapping
+        auto json_opt = json::parse(utils::load_file_without_bom(path));
+        if (!json_opt) {
+            Log.error("Failed to parse", path);
+            return nullptr;
+        }
+        auto table = std::make_shared<TaskTable>();
+        if (!table->load(*json_opt)) {
+            Log.error("Invalid tasks in", path);
+            return nullptr;
+        }
+        return table;
+    }
+
+    inline void TaskStore::build_index(TaskSnapshot& snapshot)
+    {
+        for (const auto& [path, table] : snapshot.files) {
+            for (size_t pos = 0; pos < table->size(); ++pos) {
+                snapshot.index.insert_or_assign(table->base(pos).name, TaskSnapshot::Entry { table.get(), pos });
+            }
+        }
+    }
+
+    inline TaskDiff TaskStore::diff(const TaskSnapshot& old_snapshot, const TaskSnapshot& new_snapshot)
+    {
+        auto to_json = [](const TaskSnapshot::Entry& entry) {
+            return entry.table->visit(entry.pos, [](const auto& task) { return utils::to_json(task); });
+        };
+
+        TaskDiff result;
+        for (const auto& [name, entry] : new_snapshot.index) {
+            auto iter = old_snapshot.index.find(name);
+            if (iter == old_snapshot.index.end()) {
+                result.added.emplace_back(name);
+            }
+            // tables of unchanged files are shared, no need to compare their tasks
+            else if (iter->second.table != entry.table && to_json(iter->second) != to_json(entry)) {
+                result.modified.emplace_back(name);
+            }
+        }
+        for (const auto& [name, entry] : old_snapshot.index) {
+            if (!new_snapshot.index.contains(name)) {
+                result.removed.emplace_back(name);
+            }
+        }
+        return result;
+    }
+} // namespace asst
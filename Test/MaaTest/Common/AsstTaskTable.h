@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+#include "Utils/JsonMisc.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
+
+namespace asst
+{
+    // Task storage without shared_ptr<TaskInfo> and dynamic casts.
+    // Tasks of each algorithm live by value in their own vector, and a slot per task records the algorithm and
+    // the offset into that vector, so loading is a handful of bulk allocations and dispatching on the
+    // algorithm is a switch.
+    //
+    // Positions are stable and dense. For a table loaded from json (unique names), a TaskRegistry built from
+    // tasks() gives every defined task the same index as its position here.
+    class TaskTable
+    {
+    public:
+        struct Slot
+        {
+            AlgorithmType algorithm = AlgorithmType::Invalid;
+            uint32_t offset = 0;
+        };
+
+        TaskTable() = default;
+        TaskTable(const TaskTable&) = default;
+        TaskTable(TaskTable&&) noexcept = default;
+        TaskTable& operator=(const TaskTable&) = default;
+        TaskTable& operator=(TaskTable&&) noexcept = default;
+
+        // { "TaskName": { "algorithm": "OcrDetect", ... }, ... }, a missing algorithm means MatchTemplate
+        bool load(const json::value& tasks_json);
+        void clear() noexcept;
+
+        // JustReturn tasks are stored as TaskInfo, others as their own TaskInfo subclass
+        template <typename TaskT>
+        requires(std::derived_from<std::remove_cvref_t<TaskT>, TaskInfo>)
+        size_t push_back(TaskT&& task);
+
+        size_t size() const noexcept { return m_slots.size(); }
+        bool empty() const noexcept { return m_slots.empty(); }
+        AlgorithmType algorithm(size_t pos) const noexcept { return m_slots[pos].algorithm; }
+
+        // common fields of any task
+        const TaskInfo& base(size_t pos) const;
+        // nullptr if the task at `pos` is not a TaskT, like dynamic_pointer_cast
+        template <typename TaskT>
+        const TaskT* get_if(size_t pos) const noexcept;
+        // calls func with the TaskInfo / OcrTaskInfo / MatchTaskInfo / HashTaskInfo at `pos`
+        template <typename FuncT>
+        decltype(auto) visit(size_t pos, FuncT&& func) const;
+
+        // all tasks as const TaskInfo&, in position order
+        auto tasks() const
+        {
+            return views::iota(size_t { 0 }, size()) |
+                   views::transform([this](size_t pos) -> const TaskInfo& { return base(pos); });
+        }
+
+    private:
+        template <typename TaskT>
+        static constexpr AlgorithmType algorithm_of()
+        {
+            if constexpr (std::same_as<TaskT, OcrTaskInfo>) {
+                return AlgorithmType::OcrDetect;
+            }
+            else if constexpr (std::same_as<TaskT, MatchTaskInfo>) {
+                return AlgorithmType::MatchTemplate;
+            }
+            else if constexpr (std::same_as<TaskT, HashTaskInfo>) {
+                return AlgorithmType::Hash;
+            }
+            else {
+                return AlgorithmType::JustReturn;
+            }
+        }
+
+        template <typename TaskT>
+        std::vector<TaskT>& storage() noexcept
+        {
+            return const_cast<std::vector<TaskT>&>(std::as_const(*this).storage<TaskT>());
+        }
+        template <typename TaskT>
+        const std::vector<TaskT>& storage() const noexcept
+        {
+            if constexpr (std::same_as<TaskT, OcrTaskInfo>) {
+                return m_ocr_tasks;
+            }
+            else if constexpr (std::same_as<TaskT, MatchTaskInfo>) {
+                return m_match_tasks;
+            }
+            else if constexpr (std::same_as<TaskT, HashTaskInfo>) {
+                return m_hash_tasks;
+            }
+            else {
+                return m_just_return_tasks;
+            }
+        }
+
+        template <typename TaskT>
+        bool load_task(std::string_view name, const json::value& task_json);
+
+        std::vector<Slot> m_slots;
+        std::vector<TaskInfo> m_just_return_tasks;
+        std::vector<MatchTaskInfo> m_match_tasks;
+        std::vector<OcrTaskInfo> m_ocr_tasks;
+        std::vector<HashTaskInfo> m_hash_tasks;
+    };
+
+    inline bool TaskTable::load(const json::value& tasks_json)
+    {
+        clear();
+        if (!tasks_json.is_object()) {
+            Log.error("Invalid task list");
+            return false;
+        }
+
+        // size every vector before parsing, so that each grows at most once
+        std::vector<AlgorithmType> algorithms;
+        algorithms.reserve(tasks_json.as_object().size());
+        size_t counts[4] = {};
+        for (const auto& [name, task_json] : tasks_json.as_object()) {
+            AlgorithmType algorithm = AlgorithmType::MatchTemplate;
+            if (auto algorithm_opt = task_json.find("algorithm")) {
+                if (!utils::parse_json_as(*algorithm_opt, algorithm)) {
+                    Log.error("Unknown algorithm in", name);
+                    return false;
+                }
+            }
+            algorithms.emplace_back(algorithm);
+            ++counts[static_cast<size_t>(algorithm)];
+        }
+        m_slots.reserve(algorithms.size());
+        m_just_return_tasks.reserve(counts[static_cast<size_t>(AlgorithmType::JustReturn)]);
+        m_match_tasks.reserve(counts[static_cast<size_t>(AlgorithmType::MatchTemplate)]);
+        m_ocr_tasks.reserve(counts[static_cast<size_t>(AlgorithmType::OcrDetect)]);
+        m_hash_tasks.reserve(counts[static_cast<size_t>(AlgorithmType::Hash)]);
+
+        auto algorithm_iter = algorithms.cbegin();
+        for (const auto& [name, task_json] : tasks_json.as_object()) {
+            bool ret = false;
+            switch (*algorithm_iter++) {
+            case AlgorithmType::JustReturn:
+                ret = load_task<TaskInfo>(name, task_json);
+                break;
+            case AlgorithmType::MatchTemplate:
+                ret = load_task<MatchTaskInfo>(name, task_json);
+                break;
+            case AlgorithmType::OcrDetect:
+                ret = load_task<OcrTaskInfo>(name, task_json);
+                break;
+            case AlgorithmType::Hash:
+                ret = load_task<HashTaskInfo>(name, task_json);
+                break;
+            default:
+                break;
+            }
+            if (!ret) {
+                clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline void TaskTable::clear() noexcept
+    {
+        m_slots.clear();
+        m_just_return_tasks.clear();
+        m_match_tasks.clear();
+        m_ocr_tasks.clear();
+        m_hash_tasks.clear();
+    }
+
+    template <typename TaskT>
+    requires(std::derived_from<std::remove_cvref_t<TaskT>, TaskInfo>)
+    inline size_t TaskTable::push_back(TaskT&& task)
+    {
+        using StoredT = std::remove_cvref_t<TaskT>;
+        auto& tasks = storage<StoredT>();
+        m_slots.emplace_back(Slot { algorithm_of<StoredT>(), static_cast<uint32_t>(tasks.size()) });
+        tasks.emplace_back(std::forward<TaskT>(task));
+        tasks.back().algorithm = algorithm_of<StoredT>();
+        return m_slots.size() - 1;
+    }
+
+    template <typename TaskT>
+    inline const TaskT* TaskTable::get_if(size_t pos) const noexcept
+    {
+        if constexpr (std::same_as<TaskT, TaskInfo>) {
+            return &base(pos);
+        }
+        else {
+            const Slot& slot = m_slots[pos];
+            if (slot.algorithm != algorithm_of<TaskT>()) {
+                return nullptr;
+            }
+            return &storage<TaskT>()[slot.offset];
+        }
+    }
+
+    template <typename FuncT>
+    inline decltype(auto) TaskTable::visit(size_t pos, FuncT&& func) const
+    {
+        const Slot& slot = m_slots[pos];
+        switch (slot.algorithm) {
+        case AlgorithmType::MatchTemplate:
+            return std::forward<FuncT>(func)(m_match_tasks[slot.offset]);
+        case AlgorithmType::OcrDetect:
+            return std::forward<FuncT>(func)(m_ocr_tasks[slot.offset]);
+        case AlgorithmType::Hash:
+            return std::forward<FuncT>(func)(m_hash_tasks[slot.offset]);
+        default:
+            return std::forward<FuncT>(func)(m_just_return_tasks[slot.offset]);
+        }
+    }
+
+    inline const TaskInfo& TaskTable::base(size_t pos) const
+    {
+        return visit(pos, [](const auto& task) -> const TaskInfo& { return task; });
+    }
+
+    template <typename TaskT>
+    inline bool TaskTable::load_task(std::string_view name, const json::value& task_json)
+    {
+        TaskT task;
+        task.name = name;
+        if (!utils::parse_json_fields(name, task_json, task)) {
+            return false;
+        }
+        push_back(std::move(task));
+        return true;
+    }
+} // namespace asst
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+#include "Utils/StringMisc.hpp"
+
+namespace asst
+{
+    namespace text_matcher
+    {
+        // utf8 to code points; a byte that is not part of a valid sequence becomes U+DC00 + byte, so that
+        // invalid input still only compares equal to the same bytes
+        inline void decode_utf8(std::string_view str, std::u32string& out)
+        {
+            out.clear();
+            for (size_t pos = 0; pos < str.size();) {
+                const auto lead = static_cast<uint8_t>(str[pos]);
+                if (lead < 0x80) {
+                    out.push_back(lead);
+                    ++pos;
+                    continue;
+                }
+                size_t extra = 0;
+                char32_t cp = 0;
+                if ((lead & 0xE0) == 0xC0) {
+                    extra = 1;
+                    cp = lead & 0x1F;
+                }
+                else if ((lead & 0xF0) == 0xE0) {
+                    extra = 2;
+                    cp = lead & 0x0F;
+                }
+                else if ((lead & 0xF8) == 0xF0) {
+                    extra = 3;
+                    cp = lead & 0x07;
+                }
+                bool valid = extra != 0 && pos + extra < str.size();
+                for (size_t i = 1; valid && i <= extra; ++i) {
+                    const auto byte = static_cast<uint8_t>(str[pos + i]);
+                    valid = (byte & 0xC0) == 0x80;
+                    cp = (cp << 6) | (byte & 0x3F);
+                }
+                if (!valid) {
+                    out.push_back(0xDC00 + lead);
+                    ++pos;
+                    continue;
+                }
+                out.push_back(cp);
+                pos += extra + 1;
+            }
+        }
+
+        inline uint64_t hash_bytes(std::string_view str) noexcept
+        {
+            // FNV-1a, finished with the murmur3 mixer so that the low bits are usable
+            uint64_t h = 0xcbf29ce484222325ULL;
+            for (char ch : str) {
+                h = (h ^ static_cast<uint8_t>(ch)) * 0x100000001b3ULL;
+            }
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        inline uint64_t rehash(uint64_t hash, uint32_t seed) noexcept
+        {
+            uint64_t h = hash + seed * 0x9E3779B97F4A7C15ULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        // Hash and displace perfect hash over a fixed set of strings: every key has a slot of its own, so a lookup
+        // is one hash of the input, one slot and one string comparison.
+        class PerfectHash
+        {
+        public:
+            static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+            PerfectHash() = default;
+            // keys must be distinct
+            explicit PerfectHash(const std::vector<std::string_view>& keys)
+            {
+                if (keys.empty()) {
+                    return;
+                }
+                std::vector<uint64_t> hashes;
+                hashes.reserve(keys.size());
+                for (std::string_view key : keys) {
+                    hashes.emplace_back(hash_bytes(key));
+                }
+                for (size_t slot_count = std::bit_ceil(keys.size() * 2);; slot_count *= 2) {
+                    if (build(hashes, std::max<size_t>(std::bit_ceil(keys.size() / 4 + 1), 1), slot_count)) {
+                        break;
+                    }
+                }
+            }
+
+            // the index of the key equal to str, None if there is none; keys are compared through key_at(index)
+            template <typename KeyAtF>
+            uint32_t find(std::string_view str, KeyAtF&& key_at) const
+            {
+                if (m_slots.empty()) {
+                    return None;
+                }
+                const uint64_t hash = hash_bytes(str);
+                const uint32_t seed = m_seeds[hash & (m_seeds.size() - 1)];
+                const uint32_t index = m_slots[rehash(hash, seed) & (m_slots.size() - 1)];
+                return index != None && key_at(index) == str ? index : None;
+            }
+
+        private:
+            bool build(const std::vector<uint64_t>& hashes, size_t bucket_count, size_t slot_count)
+            {
+                constexpr uint32_t MaxSeed = 1 << 16;
+
+                std::vector<std::vector<uint32_t>> buckets(bucket_count);
+                for (uint32_t index = 0; index < hashes.size(); ++index) {
+                    buckets[hashes[index] & (bucket_count - 1)].emplace_back(index);
+                }
+                std::vector<uint32_t> order(bucket_count);
+                for (uint32_t i = 0; i < bucket_count; ++i) {
+                    order[i] = i;
+                }
+                // the largest buckets are the hardest to place, they go first while the table is empty
+                std::ranges::stable_sort(order, std::greater<> {},
+                                         [&](uint32_t bucket) { return buckets[bucket].size(); });
+
+                m_seeds.assign(bucket_count, 0);
+                m_slots.assign(slot_count, None);
+                std::vector<size_t> taken;
+                for (uint32_t bucket : order) {
+                    const auto& members = buckets[bucket];
+                    if (members.empty()) {
+                        break;
+                    }
+                    bool placed = false;
+                    for (uint32_t seed = 0; seed < MaxSeed && !placed; ++seed) {
+                        taken.clear();
+                        placed = true;
+                        for (uint32_t index : members) {
+                            const size_t slot = rehash(hashes[index], seed) & (slot_count - 1);
+                            if (m_slots[slot] != None || std::ranges::find(taken, slot) != taken.end()) {
+                                placed = false;
+                                break;
+                            }
+                            taken.emplace_back(slot);
+                        }
+                        if (placed) {
+                            m_seeds[bucket] = seed;
+                            for (size_t i = 0; i < members.size(); ++i) {
+                                m_slots[taken[i]] = members[i];
+                            }
+                        }
+                    }
+                    if (!placed) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            std::vector<uint32_t> m_seeds;
+            std::vector<uint32_t> m_slots;
+        };
+
+        // Bit-parallel edit distance (Myers / Hyyro) for a pattern of up to 64 code points: one step per code
+        // point of the text, whatever the pattern length.
+        class MyersPattern
+        {
+        public:
+            static constexpr size_t MaxLength = 64;
+
+            MyersPattern() = default;
+            explicit MyersPattern(const std::u32string& pattern) : m_length(pattern.size())
+            {
+                for (size_t i = 0; i < pattern.size(); ++i) {
+                    auto iter = std::ranges::lower_bound(m_peq, pattern[i], {}, &std::pair<char32_t, uint64_t>::first);
+                    if (iter == m_peq.end() || iter->first != pattern[i]) {
+                        iter = m_peq.insert(iter, { pattern[i], 0 });
+                    }
+                    iter->second |= uint64_t(1) << i;
+                }
+            }
+
+            size_t length() const noexcept { return m_length; }
+
+            // Levenshtein distance to the whole text (substring = false), or to its closest substring
+            // (substring = true); anything above max_distance may be reported as max_distance + 1
+            int distance(const std::u32string& text, int max_distance, bool substring) const
+            {
+                if (m_length == 0) {
+                    return substring ? 0 : static_cast<int>(text.size());
+                }
+                if (!substring && std::abs(static_cast<long long>(text.size()) - static_cast<long long>(m_length)) >
+                                      max_distance) {
+                    return max_distance + 1;
+                }
+                const uint64_t high = uint64_t(1) << (m_length - 1);
+                uint64_t pv = ~uint64_t(0);
+                uint64_t mv = 0;
+                int score = static_cast<int>(m_length);
+                int best = score;
+                for (char32_t ch : text) {
+                    const uint64_t eq = peq(ch);
+                    const uint64_t xv = eq | mv;
+                    const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+                    uint64_t ph = mv | ~(xh | pv);
+                    uint64_t mh = pv & xh;
+                    if (ph & high) {
+                        ++score;
+                    }
+                    else if (mh & high) {
+                        --score;
+                    }
+                    // the first row is 0, 1, 2, ... for a whole match and all zeros for a substring
+                    ph = (ph << 1) | (substring ? 0 : 1);
+                    mh <<= 1;
+                    pv = mh | ~(xv | ph);
+                    mv = ph & xv;
+                    best = std::min(best, score);
+                }
+                return substring ? best : score;
+            }
+
+        private:
+            uint64_t peq(char32_t ch) const noexcept
+            {
+                auto iter = std::ranges::lower_bound(m_peq, ch, {}, &std::pair<char32_t, uint64_t>::first);
+                return iter != m_peq.end() && iter->first == ch ? iter->second : 0;
+            }
+
+            size_t m_length = 0;
+            // for every code point of the pattern, the bits of the positions it is at
+            std::vector<std::pair<char32_t, uint64_t>> m_peq;
+        };
+    } // namespace text_matcher
+
+    struct TextMatch
+    {
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        // index into the texts of the matcher, npos for no match
+        size_t index = npos;
+        // edit distance, in code points, 0 for an exact match
+        int distance = 0;
+
+        explicit operator bool() const noexcept { return index != npos; }
+    };
+
+    // The text candidates of an OCR task, compiled once: matching a recognized line costs one pass over the line
+    // however many candidates there are. Full match looks the line up in a perfect hash of the candidates, the
+    // substring search runs an Aho-Corasick automaton over it. Like the linear search it replaces, the first
+    // candidate of the list wins when several match.
+    //
+    // With max_distance > 0 a line matching no candidate exactly is then compared to every candidate of at most
+    // 64 code points with a bit-parallel edit distance, the full line or its closest substring depending on
+    // full_match; the closest candidate within max_distance wins.
+    class TextMatcher
+    {
+    public:
+        TextMatcher() = default;
+        TextMatcher(std::vector<std::string> texts, bool full_match, int max_distance = 0)
+            : m_texts(std::move(texts)), m_full_match(full_match), m_max_distance(std::max(max_distance, 0))
+        {
+            std::vector<std::string_view> views(m_texts.begin(), m_texts.end());
+            if (m_full_match) {
+                // only the first of duplicated candidates can ever win
+                std::vector<std::string_view> keys;
+                for (uint32_t index = 0; index < m_texts.size(); ++index) {
+                    if (std::ranges::find(views.begin(), views.begin() + index, views[index]) ==
+                        views.begin() + index) {
+                        keys.emplace_back(views[index]);
+                        m_key_texts.emplace_back(index);
+                    }
+                }
+                m_hash = text_matcher::PerfectHash(keys);
+            }
+            else {
+                m_automaton = utils::AhoCorasick(views);
+                auto empty = std::ranges::find(views, std::string_view {});
+                if (empty != views.end()) {
+                    m_empty_text = static_cast<size_t>(empty - views.begin());
+                }
+            }
+            if (m_max_distance > 0) {
+                std::u32string decoded;
+                for (const std::string& text : m_texts) {
+                    text_matcher::decode_utf8(text, decoded);
+                    m_fuzzy.emplace_back(decoded.size() <= text_matcher::MyersPattern::MaxLength
+                                             ? text_matcher::MyersPattern(decoded)
+                                             : text_matcher::MyersPattern());
+                    m_fuzzy_enabled.emplace_back(decoded.size() <= text_matcher::MyersPattern::MaxLength);
+                }
+            }
+        }
+        explicit TextMatcher(const OcrTaskInfo& task, int max_distance = 0)
+            : TextMatcher(task.text, task.full_match, max_distance)
+        {}
+
+        const std::vector<std::string>& texts() const noexcept { return m_texts; }
+
+        TextMatch match(std::string_view line) const
+        {
+            TextMatch result;
+            if (m_full_match) {
+                const uint32_t key = m_hash.find(line, [&](uint32_t key) -> std::string_view {
+                    return m_texts[m_key_texts[key]];
+                });
+                if (key != text_matcher::PerfectHash::None) {
+                    result.index = m_key_texts[key];
+                }
+            }
+            else {
+                result.index = m_empty_text;
+                m_automaton.scan(line, [&](size_t, uint32_t text) {
+                    result.index = std::min<size_t>(result.index, text);
+                    // nothing can beat the first candidate
+                    return result.index != 0;
+                });
+            }
+            if (result || m_max_distance == 0) {
+                return result;
+            }
+
+            thread_local std::u32string decoded;
+            text_matcher::decode_utf8(line, decoded);
+            int best = m_max_distance + 1;
+            for (size_t index = 0; index < m_fuzzy.size(); ++index) {
+                if (!m_fuzzy_enabled[index]) {
+                    continue;
+                }
+                const int distance = m_fuzzy[index].distance(decoded, best - 1, !m_full_match);
+                if (distance < best) {
+                    best = distance;
+                    result.index = index;
+                    result.distance = distance;
+                }
+            }
+            return result;
+        }
+
+    private:
+        std::vector<std::string> m_texts;
+        bool m_full_match = false;
+        int m_max_distance = 0;
+
+        // full match
+        text_matcher::PerfectHash m_hash;
+        // key of m_hash -> index into m_texts
+        std::vector<uint32_t> m_key_texts;
+
+        // substring
+        utils::AhoCorasick m_automaton;
+        // an empty candidate is a substring of every line
+        size_t m_empty_text = TextMatch::npos;
+
+        // fuzzy, by index into m_texts
+        std::vector<text_matcher::MyersPattern> m_fuzzy;
+        std::vector<bool> m_fuzzy_enabled;
+    };
+} // namespace asst
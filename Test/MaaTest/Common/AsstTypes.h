@@ -1,14 +1,18 @@
 #pragma once
 
+#include <array>
 #include <climits>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "Utils/EnumTable.hpp"
 #include "Utils/StringMisc.hpp"
 
 #ifndef NOMINMAX
@@ -50,6 +54,83 @@ namespace asst
         MacPlayTools = 3,
     };
 
+    inline constexpr utils::EnumTable StaticOptionKeyNames {
+        std::to_array<utils::EnumName<StaticOptionKey>>({
+            { "Invalid", StaticOptionKey::Invalid },
+            { "CpuOCR", StaticOptionKey::CpuOCR },
+            { "GpuOCR", StaticOptionKey::GpuOCR },
+        }),
+        std::to_array<utils::EnumName<StaticOptionKey>>({
+            { "CpuOCR", StaticOptionKey::CpuOCR },
+            { "GpuOCR", StaticOptionKey::GpuOCR },
+        }),
+        StaticOptionKey::Invalid,
+    };
+
+    constexpr StaticOptionKey get_static_option_key(std::string_view key_str)
+    {
+        return StaticOptionKeyNames.from_string(key_str);
+    }
+
+    constexpr std::string_view enum_to_string(StaticOptionKey key)
+    {
+        return StaticOptionKeyNames.to_string(key);
+    }
+
+    inline constexpr utils::EnumTable InstanceOptionKeyNames {
+        std::to_array<utils::EnumName<InstanceOptionKey>>({
+            { "Invalid", InstanceOptionKey::Invalid },
+            { "TouchMode", InstanceOptionKey::TouchMode },
+            { "DeploymentWithPause", InstanceOptionKey::DeploymentWithPause },
+            { "AdbLiteEnabled", InstanceOptionKey::AdbLiteEnabled },
+            { "KillAdbOnExit", InstanceOptionKey::KillAdbOnExit },
+        }),
+        std::to_array<utils::EnumName<InstanceOptionKey>>({
+            { "TouchMode", InstanceOptionKey::TouchMode },
+            { "DeploymentWithPause", InstanceOptionKey::DeploymentWithPause },
+            { "AdbLiteEnabled", InstanceOptionKey::AdbLiteEnabled },
+            { "KillAdbOnExit", InstanceOptionKey::KillAdbOnExit },
+        }),
+        InstanceOptionKey::Invalid,
+    };
+
+    constexpr InstanceOptionKey get_instance_option_key(std::string_view key_str)
+    {
+        return InstanceOptionKeyNames.from_string(key_str);
+    }
+
+    constexpr std::string_view enum_to_string(InstanceOptionKey key)
+    {
+        return InstanceOptionKeyNames.to_string(key);
+    }
+
+    // there is no invalid touch mode, anything unknown falls back to adb
+    inline constexpr utils::EnumTable TouchModeNames {
+        std::to_array<utils::EnumName<TouchMode>>({
+            { "Adb", TouchMode::Adb },
+            { "Minitouch", TouchMode::Minitouch },
+            { "Maatouch", TouchMode::Maatouch },
+            { "MacPlayTools", TouchMode::MacPlayTools },
+        }),
+        std::to_array<utils::EnumName<TouchMode>>({
+            { "Adb", TouchMode::Adb },
+            { "Minitouch", TouchMode::Minitouch },
+            { "Maatouch", TouchMode::Maatouch },
+            { "MacPlayTools", TouchMode::MacPlayTools },
+        }),
+        TouchMode::Adb,
+    };
+
+    constexpr TouchMode get_touch_mode(std::string_view mode_str)
+    {
+        return TouchModeNames.from_string(mode_str);
+    }
+
+    constexpr std::string_view enum_to_string(TouchMode mode)
+    {
+        return TouchModeNames.to_string(mode, "Unknown");
+    }
+
     namespace ControlFeat
     {
         using Feat = int64_t;
@@ -218,6 +299,22 @@ namespace asst
     };
 } // namespace asst
 
+namespace asst
+{
+    // Mixes a pair of ints into a well distributed hash (the murmur3 finalizer over both packed into 64 bits),
+    // so that (x, y) and (y, x) or neighbouring grid coordinates do not land in the same bucket.
+    constexpr uint64_t hash_int_pair(int first, int second) noexcept
+    {
+        uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(first)) << 32) | static_cast<uint32_t>(second);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+}
+
 namespace std
 {
     template <>
@@ -225,7 +322,7 @@ namespace std
     {
         size_t operator()(const asst::Point& point) const noexcept
         {
-            return std::hash<int>()(point.x) ^ std::hash<int>()(point.y);
+            return static_cast<size_t>(asst::hash_int_pair(point.x, point.y));
         }
     };
 
@@ -234,8 +331,9 @@ namespace std
     {
         size_t operator()(const asst::Rect& rect) const noexcept
         {
-            return std::hash<int>()(rect.x) ^ std::hash<int>()(rect.y) ^ std::hash<int>()(rect.width) ^
-                std::hash<int>()(rect.height);
+            const uint64_t pos = asst::hash_int_pair(rect.x, rect.y);
+            const uint64_t size = asst::hash_int_pair(rect.width, rect.height);
+            return static_cast<size_t>(pos ^ (size * 0x9e3779b97f4a7c15ULL + (pos << 6) + (pos >> 2)));
         }
     };
 }
@@ -265,34 +363,31 @@ namespace asst
         Hash
     };
 
-    inline AlgorithmType get_algorithm_type(std::string algorithm_str)
+    inline constexpr utils::EnumTable AlgorithmTypeNames {
+        std::to_array<utils::EnumName<AlgorithmType>>({
+            { "Invalid", AlgorithmType::Invalid },
+            { "JustReturn", AlgorithmType::JustReturn },
+            { "MatchTemplate", AlgorithmType::MatchTemplate },
+            { "OcrDetect", AlgorithmType::OcrDetect },
+            { "Hash", AlgorithmType::Hash },
+        }),
+        std::to_array<utils::EnumName<AlgorithmType>>({
+            { "MatchTemplate", AlgorithmType::MatchTemplate },
+            { "JustReturn", AlgorithmType::JustReturn },
+            { "OcrDetect", AlgorithmType::OcrDetect },
+            { "Hash", AlgorithmType::Hash },
+        }),
+        AlgorithmType::Invalid,
+    };
+
+    constexpr AlgorithmType get_algorithm_type(std::string_view algorithm_str)
     {
-        utils::tolowers(algorithm_str);
-        static const std::unordered_map<std::string_view, AlgorithmType> algorithm_map = {
-            { "matchtemplate", AlgorithmType::MatchTemplate },
-            { "justreturn", AlgorithmType::JustReturn },
-            { "ocrdetect", AlgorithmType::OcrDetect },
-            { "hash", AlgorithmType::Hash },
-        };
-        if (algorithm_map.contains(algorithm_str)) {
-            return algorithm_map.at(algorithm_str);
-        }
-        return AlgorithmType::Invalid;
+        return AlgorithmTypeNames.from_string(algorithm_str);
     }
 
-    inline std::string enum_to_string(AlgorithmType algo)
+    constexpr std::string_view enum_to_string(AlgorithmType algo)
     {
-        static const std::unordered_map<AlgorithmType, std::string> algorithm_map = {
-            { AlgorithmType::Invalid, "Invalid" },
-            { AlgorithmType::JustReturn, "JustReturn" },
-            { AlgorithmType::MatchTemplate, "MatchTemplate" },
-            { AlgorithmType::OcrDetect, "OcrDetect" },
-            { AlgorithmType::Hash, "Hash" },
-        };
-        if (auto it = algorithm_map.find(algo); it != algorithm_map.end()) {
-            return it->second;
-        }
-        return "Invalid";
+        return AlgorithmTypeNames.to_string(algo);
     }
 
     enum class ProcessTaskAction
@@ -307,33 +402,37 @@ namespace asst
         Swipe = 0x1000,             // 
     };
 
-    inline ProcessTaskAction get_action_type(std::string action_str)
+    inline constexpr utils::EnumTable ProcessTaskActionNames {
+        std::to_array<utils::EnumName<ProcessTaskAction>>({
+            { "Invalid", ProcessTaskAction::Invalid },
+            { "BasicClick", ProcessTaskAction::BasicClick },
+            { "ClickSelf", ProcessTaskAction::ClickSelf },
+            { "ClickRect", ProcessTaskAction::ClickRect },
+            { "ClickRand", ProcessTaskAction::ClickRand },
+            { "DoNothing", ProcessTaskAction::DoNothing },
+            { "Stop", ProcessTaskAction::Stop },
+            { "Swipe", ProcessTaskAction::Swipe },
+        }),
+        std::to_array<utils::EnumName<ProcessTaskAction>>({
+            { "ClickSelf", ProcessTaskAction::ClickSelf },
+            { "ClickRand", ProcessTaskAction::ClickRand },
+            { "", ProcessTaskAction::DoNothing },
+            { "DoNothing", ProcessTaskAction::DoNothing },
+            { "Stop", ProcessTaskAction::Stop },
+            { "ClickRect", ProcessTaskAction::ClickRect },
+            { "Swipe", ProcessTaskAction::Swipe },
+        }),
+        ProcessTaskAction::Invalid,
+    };
+
+    constexpr ProcessTaskAction get_action_type(std::string_view action_str)
     {
-        utils::tolowers(action_str);
-        static const std::unordered_map<std::string, ProcessTaskAction> action_map = {
-            { "clickself", ProcessTaskAction::ClickSelf }, { "clickrand", ProcessTaskAction::ClickRand },
-            { "", ProcessTaskAction::DoNothing },          { "donothing", ProcessTaskAction::DoNothing },
-            { "stop", ProcessTaskAction::Stop },           { "clickrect", ProcessTaskAction::ClickRect },
-            { "swipe", ProcessTaskAction::Swipe },
-        };
-        if (auto it = action_map.find(action_str); it != action_map.end()) {
-            return it->second;
-        }
-        return ProcessTaskAction::Invalid;
+        return ProcessTaskActionNames.from_string(action_str);
     }
 
-    inline std::string enum_to_string(ProcessTaskAction action)
+    constexpr std::string_view enum_to_string(ProcessTaskAction action)
     {
-        static const std::unordered_map<ProcessTaskAction, std::string> action_map = {
-            { ProcessTaskAction::Invalid, "Invalid" },     { ProcessTaskAction::BasicClick, "BasicClick" },
-            { ProcessTaskAction::ClickSelf, "ClickSelf" }, { ProcessTaskAction::ClickRect, "ClickRect" },
-            { ProcessTaskAction::ClickRand, "ClickRand" }, { ProcessTaskAction::DoNothing, "DoNothing" },
-            { ProcessTaskAction::Stop, "Stop" },           { ProcessTaskAction::Swipe, "Swipe" },
-        };
-        if (auto it = action_map.find(action); it != action_map.end()) {
-            return it->second;
-        }
-        return "Invalid";
+        return ProcessTaskActionNames.to_string(action);
     }
 } // namespace asst
 
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace asst::utils
+{
+    template <typename EnumT>
+    requires std::is_enum_v<EnumT>
+    struct EnumName
+    {
+        std::string_view name;
+        EnumT value;
+    };
+
+    namespace detail
+    {
+        constexpr char ascii_tolower(char ch) noexcept
+        {
+            return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+        }
+
+        constexpr bool iequals(std::string_view lhs, std::string_view rhs) noexcept
+        {
+            if (lhs.size() != rhs.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < lhs.size(); ++i) {
+                if (ascii_tolower(lhs[i]) != ascii_tolower(rhs[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr uint32_t mix32(uint32_t h) noexcept
+        {
+            h ^= h >> 16;
+            h *= 0x7feb352dU;
+            h ^= h >> 15;
+            h *= 0x846ca68bU;
+            h ^= h >> 16;
+            return h;
+        }
+
+        // FNV-1a over the lowercased bytes, so that names differing only in case hash alike
+        constexpr uint32_t ihash(std::string_view str, uint32_t seed) noexcept
+        {
+            uint32_t h = 0x811c9dc5U ^ seed;
+            for (char ch : str) {
+                h = (h ^ static_cast<uint8_t>(ascii_tolower(ch))) * 0x01000193U;
+            }
+            return mix32(h);
+        }
+
+        constexpr uint32_t value_hash(int64_t value, uint32_t seed) noexcept
+        {
+            return mix32(static_cast<uint32_t>(value) ^ mix32(static_cast<uint32_t>(value >> 32) ^ seed));
+        }
+
+        // the first seed giving every key a slot of its own, keys being hashed by hash(key, seed) and distinct
+        template <size_t Slots, typename KeyT, size_t N, typename HashF>
+        consteval uint32_t find_seed(const std::array<KeyT, N>& keys, HashF hash)
+        {
+            for (uint32_t seed = 0;; ++seed) {
+                std::array<bool, Slots> used {};
+                bool collision = false;
+                for (const KeyT& key : keys) {
+                    bool& slot = used[hash(key, seed) & (Slots - 1)];
+                    if (slot) {
+                        collision = true;
+                        break;
+                    }
+                    slot = true;
+                }
+                if (!collision) {
+                    return seed;
+                }
+            }
+        }
+    } // namespace detail
+
+    // Enum <-> string tables built at compile time. Both directions go through a perfect hash found by the
+    // compiler: one hash, one slot, one comparison, no allocation. Parsing ignores ASCII case and accepts the
+    // `aliases`; printing gives the canonical name from `names`, which must list every value at most once.
+    template <typename EnumT, size_t NameCount, size_t AliasCount>
+    class EnumTable
+    {
+        static constexpr size_t NameSlots = std::bit_ceil(NameCount * 2);
+        static constexpr size_t AliasSlots = std::bit_ceil(AliasCount * 2);
+        static constexpr uint8_t Empty = 0xFF;
+        static_assert(NameCount < Empty && AliasCount < Empty);
+
+        using underlying_t = std::underlying_type_t<EnumT>;
+
+    public:
+        consteval EnumTable(const std::array<EnumName<EnumT>, NameCount>& names,
+                            const std::array<EnumName<EnumT>, AliasCount>& aliases, EnumT invalid)
+            : m_names(names), m_aliases(aliases), m_invalid(invalid)
+        {
+            std::array<int64_t, NameCount> values {};
+            for (size_t i = 0; i < NameCount; ++i) {
+                values[i] = static_cast<int64_t>(names[i].value);
+            }
+            std::array<std::string_view, AliasCount> alias_names {};
+            for (size_t i = 0; i < AliasCount; ++i) {
+                alias_names[i] = aliases[i].name;
+            }
+            for (size_t i = 0; i < NameCount; ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (values[i] == values[j]) throw "EnumTable: a value is named twice";
+                }
+            }
+            for (size_t i = 0; i < AliasCount; ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (detail::iequals(alias_names[i], alias_names[j])) throw "EnumTable: duplicated alias";
+                }
+            }
+            m_name_seed = detail::find_seed<NameSlots>(values, detail::value_hash);
+            m_alias_seed = detail::find_seed<AliasSlots>(alias_names, detail::ihash);
+
+            m_name_slots.fill(Empty);
+            m_alias_slots.fill(Empty);
+            for (size_t i = 0; i < NameCount; ++i) {
+                m_name_slots[detail::value_hash(values[i], m_name_seed) & (NameSlots - 1)] = static_cast<uint8_t>(i);
+            }
+            for (size_t i = 0; i < AliasCount; ++i) {
+                m_alias_slots[detail::ihash(alias_names[i], m_alias_seed) & (AliasSlots - 1)] =
+                    static_cast<uint8_t>(i);
+            }
+        }
+
+        // `invalid` for anything that is not an alias
+        constexpr EnumT from_string(std::string_view str) const noexcept
+        {
+            if constexpr (AliasCount == 0) {
+                return m_invalid;
+            }
+            else {
+                const uint8_t index = m_alias_slots[detail::ihash(str, m_alias_seed) & (AliasSlots - 1)];
+                if (index == Empty || !detail::iequals(m_aliases[index].name, str)) {
+                    return m_invalid;
+                }
+                return m_aliases[index].value;
+            }
+        }
+
+        // fallback for values without a name
+        constexpr std::string_view to_string(EnumT value, std::string_view fallback = "Invalid") const noexcept
+        {
+            const auto key = static_cast<int64_t>(static_cast<underlying_t>(value));
+            const uint8_t index = m_name_slots[detail::value_hash(key, m_name_seed) & (NameSlots - 1)];
+            if (index == Empty || m_names[index].value != value) {
+                return fallback;
+            }
+            return m_names[index].name;
+        }
+
+    private:
+        std::array<EnumName<EnumT>, NameCount> m_names;
+        std::array<EnumName<EnumT>, AliasCount> m_aliases;
+        EnumT m_invalid;
+        uint32_t m_name_seed = 0;
+        uint32_t m_alias_seed = 0;
+        std::array<uint8_t, NameSlots> m_name_slots {};
+        std::array<uint8_t, AliasSlots> m_alias_slots {};
+    };
+
+    // Enum -> name for enums laid out in blocks of consecutive values, e.g. 0.., 10000.., 20000..: the name is
+    // found by dividing the value by the block size and indexing, without hashing. Built at compile time; a
+    // value outside of the blocks or named twice stops the build.
+    template <typename EnumT, int BlockSize, size_t BlockCount, size_t BlockCapacity>
+    class SparseEnumNames
+    {
+        using underlying_t = std::underlying_type_t<EnumT>;
+
+    public:
+        template <size_t NameCount>
+        consteval SparseEnumNames(const std::array<EnumName<EnumT>, NameCount>& names)
+        {
+            for (const auto& [name, value] : names) {
+                const auto id = static_cast<long long>(static_cast<underlying_t>(value));
+                if (id < 0 || id / BlockSize >= static_cast<long long>(BlockCount) ||
+                    id % BlockSize >= static_cast<long long>(BlockCapacity)) {
+                    throw "SparseEnumNames: value outside of the blocks";
+                }
+                std::string_view& slot = m_blocks[id / BlockSize][id % BlockSize];
+                if (!slot.empty()) {
+                    throw "SparseEnumNames: a value is named twice";
+                }
+                slot = name;
+            }
+        }
+
+        // fallback for values without a name
+        constexpr std::string_view to_string(EnumT value, std::string_view fallback = "Unknown") const noexcept
+        {
+            const auto id = static_cast<long long>(static_cast<underlying_t>(value));
+            if (id < 0 || id / BlockSize >= static_cast<long long>(BlockCount) ||
+                id % BlockSize >= static_cast<long long>(BlockCapacity)) {
+                return fallback;
+            }
+            const std::string_view name = m_blocks[id / BlockSize][id % BlockSize];
+            return name.empty() ? fallback : name;
+        }
+
+    private:
+        // string_view default constructs empty; no `{}` here, GCC 12 then rejects reading the table in constexpr
+        std::array<std::array<std::string_view, BlockCapacity>, BlockCount> m_blocks;
+    };
+} // namespace asst::utils
@@ -2,10 +2,15 @@
 
 #include <concepts>
 #include <meojson/json.hpp>
+#include <meojson/json_view.hpp>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 #include "Common/AsstTypes.h"
+#include "Locale.hpp"
 #include "Logger.hpp"
+#include "Platform.hpp"
 
 namespace asst::utils
 {
@@ -148,4 +153,228 @@ namespace asst::utils
         OutT output;
         return get_value_or(repr, input, key, output, std::forward<DefaultT>(default_val)) ? output : std::nullopt;
     }
+
+    // json field descriptors
+    // A struct is bound to json by specializing JsonFields with ASST_JSON_FIELDS, listing every member once.
+    // parse_json_fields() then decodes an object in a single pass over its members and to_json() writes it
+    // back, instead of looking every key up with find().
+    //
+    //     ASST_JSON_FIELDS(Foo, ASST_JSON_FIELD(Foo, max_times, "maxTimes"), ...);
+
+    inline constexpr size_t json_key_hash(std::string_view key) noexcept
+    {
+        // FNV-1a
+        size_t hash = static_cast<size_t>(14695981039346656037ULL);
+        for (char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * static_cast<size_t>(1099511628211ULL);
+        }
+        return hash;
+    }
+
+    template <typename ClassT, typename MemberT>
+    struct JsonField
+    {
+        using class_type = ClassT;
+        using member_type = MemberT;
+
+        constexpr JsonField(std::string_view key, MemberT ClassT::*member) noexcept
+            : key(key), hash(json_key_hash(key)), member(member)
+        {}
+        // fields of a base class are reused as they are by derived classes
+        template <typename BaseT>
+        requires(std::derived_from<ClassT, BaseT>)
+        constexpr JsonField(const JsonField<BaseT, MemberT>& base) noexcept
+            : key(base.key), hash(base.hash), member(base.member)
+        {}
+
+        std::string_view key;
+        size_t hash;
+        MemberT ClassT::*member;
+    };
+
+    template <typename T>
+    struct JsonFields;
+
+    template <typename T>
+    concept JsonDescribed = requires { JsonFields<T>::value; };
+
+    template <typename DerivedT, typename BaseT>
+    requires(std::derived_from<DerivedT, BaseT> && JsonDescribed<BaseT>)
+    constexpr auto inherit_json_fields()
+    {
+        return std::apply(
+            [](const auto&... field) {
+                return std::make_tuple(
+                    JsonField<DerivedT, typename std::remove_cvref_t<decltype(field)>::member_type>(field)...);
+            },
+            JsonFields<BaseT>::value);
+    }
+
+#define ASST_JSON_FIELD(Class, Member, Key) \
+    ::asst::utils::JsonField<Class, decltype(Class::Member)>(Key, &Class::Member)
+
+#define ASST_JSON_FIELDS(Class, ...)                                  \
+    template <>                                                       \
+    struct asst::utils::JsonFields<Class>                             \
+    {                                                                 \
+        static constexpr auto value = std::make_tuple(__VA_ARGS__); \
+    }
+
+    // inherits all fields of Base, then adds its own
+#define ASST_JSON_FIELDS_DERIVED(Class, Base, ...)                                                         \
+    template <>                                                                                            \
+    struct asst::utils::JsonFields<Class>                                                                  \
+    {                                                                                                      \
+        static constexpr auto value =                                                                      \
+            std::tuple_cat(::asst::utils::inherit_json_fields<Class, Base>(), std::make_tuple(__VA_ARGS__)); \
+    }
+
+    // Fields missing from `input` keep their current value; unknown keys are ignored.
+    template <JsonDescribed OutT>
+    bool parse_json_fields(std::string_view repr, const json::value& input, OutT& output)
+    {
+        if (!input.is_object()) {
+            Log.error("Invalid type of", repr);
+            return false;
+        }
+        for (const auto& [key, val] : input.as_object()) {
+            const size_t key_hash = json_key_hash(key);
+            bool matched = false;
+            bool parsed = false;
+            auto try_field = [&](const auto& field) {
+                if (matched || field.hash != key_hash || field.key != key) {
+                    return;
+                }
+                matched = true;
+                parsed = parse_json_as(val, output.*(field.member));
+            };
+            std::apply([&](const auto&... field) { (try_field(field), ...); }, JsonFields<OutT>::value);
+            if (matched && !parsed) {
+                Log.error("Invalid type of", key, "in", repr);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <JsonDescribed OutT>
+    bool parse_json_as(const json::value& input, OutT& output)
+    {
+        return input.is_object() && parse_json_fields("", input, output);
+    }
+
+    // serialization, the reverse of parse_json_as
+    inline json::value to_json(AlgorithmType input)
+    {
+        return std::string(enum_to_string(input));
+    }
+
+    inline json::value to_json(ProcessTaskAction input)
+    {
+        return std::string(enum_to_string(input));
+    }
+
+    inline json::value to_json(const asst::Rect& input)
+    {
+        return json::array { input.x, input.y, input.width, input.height };
+    }
+
+    template <typename InT>
+    requires(std::constructible_from<json::value, InT>)
+    json::value to_json(const InT& input)
+    {
+        return json::value(input);
+    }
+
+    template <typename FirstT, typename SecondT>
+    json::value to_json(const std::pair<FirstT, SecondT>& input)
+    {
+        return json::array { to_json(input.first), to_json(input.second) };
+    }
+
+    template <typename ValT>
+    json::value to_json(const std::vector<ValT>& input)
+    {
+        json::array result;
+        for (const auto& val : input) {
+            result.emplace_back(to_json(val));
+        }
+        return result;
+    }
+
+    template <JsonDescribed InT>
+    json::value to_json(const InT& input)
+    {
+        json::object result;
+        std::apply([&](const auto&... field) { (result.emplace(field.key, to_json(input.*(field.member))), ...); },
+                   JsonFields<InT>::value);
+        return result;
+    }
+
+    // json::open(path, true) without its copies of the file: parsed straight from the mapped content, past the BOM.
+    // Not for files that may be truncated meanwhile, e.g. by the hot reload: reading past the new end is a SIGBUS.
+    inline std::optional<json::value> open_json(const std::filesystem::path& path)
+    {
+        FileView file(path);
+        if (!file.valid()) {
+            return std::nullopt;
+        }
+        return json::parse(file.view());
+    }
+
+    // read-only json document parsed in place over a memory-mapped file,
+    // strings and numbers in `doc` point into `file`
+    struct MappedJson
+    {
+        FileView file;
+        json::document doc;
+
+        json::view root() const noexcept { return doc.root(); }
+    };
+
+    inline std::optional<MappedJson> open_json_view(const std::filesystem::path& path)
+    {
+        FileView file(path);
+        if (!file.valid()) {
+            return std::nullopt;
+        }
+        auto doc = json::document::parse(file.view());
+        if (!doc) {
+            return std::nullopt;
+        }
+        return MappedJson { std::move(file), std::move(*doc) };
+    }
 } // namespace asst::utils
+
+ASST_JSON_FIELDS(asst::TaskInfo, ASST_JSON_FIELD(asst::TaskInfo, algorithm, "algorithm"),
+                 ASST_JSON_FIELD(asst::TaskInfo, action, "action"), ASST_JSON_FIELD(asst::TaskInfo, sub, "sub"),
+                 ASST_JSON_FIELD(asst::TaskInfo, sub_error_ignored, "subErrorIgnored"),
+                 ASST_JSON_FIELD(asst::TaskInfo, next, "next"),
+                 ASST_JSON_FIELD(asst::TaskInfo, max_times, "maxTimes"),
+                 ASST_JSON_FIELD(asst::TaskInfo, exceeded_next, "exceededNext"),
+                 ASST_JSON_FIELD(asst::TaskInfo, on_error_next, "onErrorNext"),
+                 ASST_JSON_FIELD(asst::TaskInfo, reduce_other_times, "reduceOtherTimes"),
+                 ASST_JSON_FIELD(asst::TaskInfo, specific_rect, "specificRect"),
+                 ASST_JSON_FIELD(asst::TaskInfo, pre_delay, "preDelay"),
+                 ASST_JSON_FIELD(asst::TaskInfo, post_delay, "postDelay"),
+                 ASST_JSON_FIELD(asst::TaskInfo, retry_times, "retryTimes"),
+                 ASST_JSON_FIELD(asst::TaskInfo, roi, "roi"), ASST_JSON_FIELD(asst::TaskInfo, rect_move, "rectMove"),
+                 ASST_JSON_FIELD(asst::TaskInfo, cache, "cache"),
+                 ASST_JSON_FIELD(asst::TaskInfo, special_params, "specialParams"));
+
+ASST_JSON_FIELDS_DERIVED(asst::OcrTaskInfo, asst::TaskInfo, ASST_JSON_FIELD(asst::OcrTaskInfo, text, "text"),
+                         ASST_JSON_FIELD(asst::OcrTaskInfo, full_match, "fullMatch"),
+                         ASST_JSON_FIELD(asst::OcrTaskInfo, is_ascii, "isAscii"),
+                         ASST_JSON_FIELD(asst::OcrTaskInfo, without_det, "withoutDet"),
+                         ASST_JSON_FIELD(asst::OcrTaskInfo, replace_full, "replaceFull"),
+                         ASST_JSON_FIELD(asst::OcrTaskInfo, replace_map, "ocrReplace"));
+
+ASST_JSON_FIELDS_DERIVED(asst::MatchTaskInfo, asst::TaskInfo,
+                         ASST_JSON_FIELD(asst::MatchTaskInfo, templ_names, "template"),
+                         ASST_JSON_FIELD(asst::MatchTaskInfo, templ_thresholds, "templThreshold"),
+                         ASST_JSON_FIELD(asst::MatchTaskInfo, mask_range, "maskRange"));
+
+ASST_JSON_FIELDS_DERIVED(asst::HashTaskInfo, asst::TaskInfo, ASST_JSON_FIELD(asst::HashTaskInfo, hashes, "hash"),
+                         ASST_JSON_FIELD(asst::HashTaskInfo, dist_threshold, "threshold"),
+                         ASST_JSON_FIELD(asst::HashTaskInfo, mask_range, "maskRange"),
+                         ASST_JSON_FIELD(asst::HashTaskInfo, bound, "bound"));
@@ -5,8 +5,10 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "Meta.hpp"
+#include "Platform.hpp"
 
 #ifdef _WIN32
 #include "Platform/SafeWindows.h"
@@ -113,20 +115,84 @@ namespace asst::utils
 #endif
     }
 
+    // Reads the file once, straight into the returned string; the BOM is never copied.
     inline std::string load_file_without_bom(const std::filesystem::path& path)
     {
         std::ifstream ifs(path, std::ios::in);
         if (!ifs.is_open()) {
             return {};
         }
-        std::stringstream iss;
-        iss << ifs.rdbuf();
-        ifs.close();
-        std::string str = iss.str();
+        char head[3] = {};
+        ifs.read(head, sizeof(head));
+        std::string str(head, static_cast<size_t>(ifs.gcount()));
+        if (str == "\xEF\xBB\xBF") {
+            str.clear();
+        }
+        if (!ifs) {
+            return str;
+        }
 
-        if (str.starts_with("\xEF\xBB\xBF")) {
-            str.assign(str.begin() + 3, str.end());
+        std::error_code ec;
+        const auto file_size = std::filesystem::file_size(path, ec);
+        const size_t prefix = str.size();
+        if (!ec && file_size > sizeof(head)) {
+            // in text mode fewer characters than the file size may come out
+            str.resize(prefix + static_cast<size_t>(file_size) - sizeof(head));
+            ifs.read(str.data() + prefix, static_cast<std::streamsize>(str.size() - prefix));
+            str.resize(prefix + static_cast<size_t>(ifs.gcount()));
+        }
+        // the size is unknown (pipes, procfs, ...) or the file grew meanwhile
+        char chunk[4096];
+        while (ifs.read(chunk, sizeof(chunk)) || ifs.gcount() > 0) {
+            str.append(chunk, static_cast<size_t>(ifs.gcount()));
         }
         return str;
     }
+
+    // The content of a file past its utf8 BOM, with no copy for regular files, which are mapped. Anything that
+    // cannot be mapped (pipes, procfs, ...) is read once into a buffer of its own. The view stays valid as long
+    // as the FileView lives, moves included.
+    class FileView
+    {
+    public:
+        FileView() = default;
+        explicit FileView(const std::filesystem::path& path)
+        {
+            platform::mapped_file file(path);
+            if (file.valid() && file.size() != 0) {
+                m_file = std::move(file);
+                m_valid = true;
+            }
+            else {
+                // an empty size may as well mean "unknown"
+                std::ifstream ifs(path, std::ios::in | std::ios::binary);
+                if (!ifs.is_open()) {
+                    return;
+                }
+                char chunk[4096];
+                while (ifs.read(chunk, sizeof(chunk)) || ifs.gcount() > 0) {
+                    m_buffer.insert(m_buffer.end(), chunk, chunk + ifs.gcount());
+                }
+                m_valid = true;
+            }
+            if (content().starts_with("\xEF\xBB\xBF")) {
+                m_offset = 3;
+            }
+        }
+
+        bool valid() const noexcept { return m_valid; }
+        std::string_view view() const noexcept { return content().substr(m_offset); }
+
+    private:
+        std::string_view content() const noexcept
+        {
+            return m_file.data() ? m_file.view() : std::string_view(m_buffer.data(), m_buffer.size());
+        }
+
+        platform::mapped_file m_file;
+        // a vector, not a string: its data never moves with the object
+        std::vector<char> m_buffer;
+        size_t m_offset = 0;
+        bool m_valid = false;
+    };
 } // namespace asst::utils
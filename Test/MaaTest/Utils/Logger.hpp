@@ -392,7 +392,13 @@ namespace asst
             static Stream& stream_put(Stream& s, T&& v)
             {
                 if constexpr (std::same_as<std::filesystem::path, remove_cvref_t<T>>) {
-                    s << utils::path_to_utf8_string(std::forward<T>(v));
+                    if constexpr (std::same_as<utils::os_string, std::string>) {
+                        // already utf8, no need for a copy
+                        s << v.native();
+                    }
+                    else {
+                        s << utils::path_to_utf8_string(std::forward<T>(v));
+                    }
                 }
                 else if constexpr (std::same_as<Logger::level, remove_cvref_t<T>>) {
                     constexpr int buff_len = 128;
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
 #include "Platform/Platform.h"
 
 namespace asst::utils
@@ -21,12 +27,81 @@ namespace asst::utils
 
     using platform::call_command;
 
+    // Paths interned by their utf8 string: the first request builds the path, every later one returns the same
+    // object without allocating. Meant for the fixed set of resource paths used again and again, entries are
+    // never removed.
+    class PathCache
+    {
+    public:
+        static PathCache& get_instance()
+        {
+            static PathCache cache;
+            return cache;
+        }
+
+        const std::filesystem::path& get(std::string_view utf8_str)
+        {
+            {
+                std::shared_lock<std::shared_mutex> lock(m_mutex);
+                if (auto iter = m_paths.find(utf8_str); iter != m_paths.end()) {
+                    return *iter->second;
+                }
+            }
+            auto interned = std::make_unique<std::filesystem::path>(path(std::string(utf8_str)));
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            // another thread may have been faster, emplace keeps its path
+            auto [iter, inserted] = m_paths.try_emplace(std::string(utf8_str), std::move(interned));
+            return *iter->second;
+        }
+
+        size_t size() const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            return m_paths.size();
+        }
+
+    private:
+        struct StringHash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>()(str); }
+        };
+
+        PathCache() = default;
+
+        mutable std::shared_mutex m_mutex;
+        // the paths live on the heap, so references stay valid when the map rehashes
+        std::unordered_map<std::string, std::unique_ptr<std::filesystem::path>, StringHash, std::equal_to<>>
+            m_paths;
+    };
+
+    inline const std::filesystem::path& interned_path(std::string_view utf8_str)
+    {
+        return PathCache::get_instance().get(utf8_str);
+    }
+
     namespace path_literals
     {
-        inline std::filesystem::path operator"" _p(const char* utf8_str, size_t len)
+        namespace detail
+        {
+            // a string literal as a template argument, so that every literal gets its own instantiation
+            template <size_t N>
+            struct LiteralString
+            {
+                char value[N] = {};
+
+                constexpr LiteralString(const char (&str)[N]) { std::copy_n(str, N, value); }
+                constexpr std::string_view view() const noexcept { return { value, N - 1 }; }
+            };
+        }
+
+        // "resource/tasks.json"_p: the path is converted once, on the first evaluation of each literal,
+        // every later evaluation returns the same object
+        template <detail::LiteralString Str>
+        inline const std::filesystem::path& operator""_p()
         {
-            // 日后再优化（
-            return asst::utils::path(std::string(std::string_view(utf8_str, len)));
+            static const std::filesystem::path path = asst::utils::path(std::string(Str.view()));
+            return path;
         }
     }
 } // namespace asst::utils
@@ -1,11 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <new>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #ifdef _WIN32
 #include "PlatformWin32.h"
@@ -16,8 +25,72 @@
 
 namespace asst::platform
 {
+    struct command_options
+    {
+        // 0 waits for as long as the command runs
+        std::chrono::milliseconds timeout { 0 };
+        // written to the stdin of the command, which is closed afterwards
+        std::string_view input;
+        // called with every chunk of output as it arrives, in addition to collecting it
+        std::function<void(std::string_view)> on_output;
+        // checked while waiting, the command is killed as soon as it becomes true
+        bool* exit_flag = nullptr;
+        // output past this many bytes is read and dropped, 0 keeps everything
+        size_t max_output = 0;
+    };
+
+    struct command_result
+    {
+        // stdout and stderr, interleaved as written
+        std::string output;
+        // 127 with "<program>: not found" in output if the program does not exist, 126 if it cannot be
+        // executed, as from sh; -1 if no process could be started, or it was killed for the timeout or exit_flag
+        int exit_code = -1;
+        bool timed_out = false;
+        bool canceled = false;
+        // output went beyond max_output
+        bool truncated = false;
+    };
+
+    // Runs cmdline, on POSIX through `sh -c` only when it uses shell syntax, otherwise split at whitespace and
+    // started directly. The calling thread sleeps until output arrives, the command exits, or the timeout
+    // expires, so waiting costs no CPU however many commands run at once.
+    command_result run_command(const std::string& cmdline, const command_options& options = {});
     std::string call_command(const std::string& cmdline, bool* exit_flag = nullptr);
 
+    // Starts cmdline like run_command and returns at once. All the commands started this way are waited for
+    // by a single I/O thread, so one thread can keep several device commands in flight and collect the
+    // results later. options.input is copied; on_output is called on the I/O thread and must not block.
+    // The output is collected into `buffer`, whose capacity is reused: pass the output of a previous result
+    // back to avoid growing a new string for every command. On Windows each command is waited for by a thread
+    // of its own.
+    std::future<command_result> run_command_async(const std::string& cmdline, command_options options = {},
+                                                  std::string buffer = {});
+
+    // A long-lived `sh` that runs commands one after another, calls from several threads being serialized.
+    // A command costs a pipe round trip instead of starting a process, and shell state such as the current
+    // directory or exported variables carries over to the next command. Commands read their stdin from
+    // /dev/null, options.input is not supported. After a timeout, a cancel or an `exit` the shell is started
+    // again by the next command. On Windows every command is started on its own, like run_command.
+    class shell_session
+    {
+        struct impl;
+        std::unique_ptr<impl> _impl;
+
+    public:
+        shell_session();
+        ~shell_session();
+
+        // disable copy construct
+        shell_session(const shell_session&) = delete;
+        shell_session& operator=(const shell_session&) = delete;
+
+        shell_session(shell_session&&) noexcept;
+        shell_session& operator=(shell_session&&) noexcept;
+
+        command_result run(const std::string& cmdline, const command_options& options = {});
+    };
+
     using os_string = std::filesystem::path::string_type;
 
     inline std::filesystem::path path(const os_string& os_str)
@@ -88,42 +161,267 @@ namespace asst::platform
     void* aligned_alloc(size_t len, size_t align);
     void aligned_free(void* ptr);
 
+    // 0 when the system has no transparent huge pages
+    extern const size_t huge_page_size;
+
+    // Page-aligned memory straight from the OS, size being a multiple of page_size. With `huge`, size is a
+    // multiple of huge_page_size and the block is aligned to it and marked for transparent huge pages.
+    void* map_pages(size_t size, bool huge);
+    void unmap_pages(void* ptr, size_t size);
+
+    struct page_pool_stats
+    {
+        size_t in_use_bytes = 0;
+        size_t peak_in_use_bytes = 0;
+        size_t cached_bytes = 0;
+        size_t huge_bytes = 0; // in use or cached
+        size_t os_allocations = 0;
+        size_t os_frees = 0;
+        size_t reuses = 0;
+    };
+
+    // Recycles page-aligned blocks, so that screenshot and pipe buffers of the same size are not mapped and
+    // unmapped again for every capture. Blocks are rounded up to whole pages, or to whole huge pages from
+    // huge_page_size on; a released block is cached for the next acquire of the same size, as long as the
+    // cache stays below its limit.
+    class page_pool
+    {
+    public:
+        static constexpr size_t DefaultCacheLimit = 64 * 1024 * 1024;
+
+        static page_pool& instance()
+        {
+            // never destroyed, buffers owned by other statics may be released after exit() began
+            static page_pool* pool = new page_pool;
+            return *pool;
+        }
+
+        // disable copy construct
+        page_pool(const page_pool&) = delete;
+        page_pool& operator=(const page_pool&) = delete;
+
+        // the size acquire really hands out for size bytes
+        static size_t block_size(size_t size) noexcept
+        {
+            const size_t unit = (huge_page_size != 0 && size >= huge_page_size) ? huge_page_size : page_size;
+            return (std::max<size_t>(size, 1) + unit - 1) / unit * unit;
+        }
+
+        // a block of block_size(size) bytes, nullptr if the system is out of memory
+        void* acquire(size_t size)
+        {
+            const size_t bytes = block_size(size);
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                auto iter = _cache.find(bytes);
+                if (iter != _cache.end() && !iter->second.empty()) {
+                    void* ptr = iter->second.back();
+                    iter->second.pop_back();
+                    _stats.cached_bytes -= bytes;
+                    ++_stats.reuses;
+                    add_in_use(bytes);
+                    return ptr;
+                }
+            }
+            const bool huge = is_huge(bytes);
+            void* ptr = map_pages(bytes, huge);
+            if (!ptr) {
+                return nullptr;
+            }
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_stats.os_allocations;
+            if (huge) _stats.huge_bytes += bytes;
+            add_in_use(bytes);
+            return ptr;
+        }
+
+        // bytes being the block_size() of the acquire
+        void release(void* ptr, size_t bytes)
+        {
+            if (!ptr) return;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _stats.in_use_bytes -= bytes;
+                if (_stats.cached_bytes + bytes <= _cache_limit) {
+                    _cache[bytes].emplace_back(ptr);
+                    _stats.cached_bytes += bytes;
+                    return;
+                }
+                ++_stats.os_frees;
+                if (is_huge(bytes)) _stats.huge_bytes -= bytes;
+            }
+            unmap_pages(ptr, bytes);
+        }
+
+        // gives every cached block back to the OS
+        void trim()
+        {
+            std::map<size_t, std::vector<void*>> cache;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                cache.swap(_cache);
+                for (const auto& [bytes, blocks] : cache) {
+                    _stats.os_frees += blocks.size();
+                    if (is_huge(bytes)) _stats.huge_bytes -= bytes * blocks.size();
+                }
+                _stats.cached_bytes = 0;
+            }
+            for (const auto& [bytes, blocks] : cache) {
+                for (void* ptr : blocks) {
+                    unmap_pages(ptr, bytes);
+                }
+            }
+        }
+
+        // lowering the limit does not trim what is already cached
+        void set_cache_limit(size_t bytes)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cache_limit = bytes;
+        }
+
+        page_pool_stats stats() const
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            return _stats;
+        }
+
+    private:
+        page_pool() = default;
+
+        static bool is_huge(size_t bytes) noexcept { return huge_page_size != 0 && bytes >= huge_page_size; }
+
+        void add_in_use(size_t bytes)
+        {
+            _stats.in_use_bytes += bytes;
+            _stats.peak_in_use_bytes = std::max(_stats.peak_in_use_bytes, _stats.in_use_bytes);
+        }
+
+        mutable std::mutex _mutex;
+        // released blocks by size
+        std::map<size_t, std::vector<void*>> _cache;
+        size_t _cache_limit = DefaultCacheLimit;
+        page_pool_stats _stats;
+    };
+
+    // a buffer of whole pages from page_pool, at least as large as asked for
     template <typename TElem>
     requires std::is_trivial_v<TElem>
-    class single_page_buffer
+    class page_buffer
     {
         TElem* _ptr = nullptr;
+        size_t _bytes = 0;
 
     public:
-        single_page_buffer()
+        explicit page_buffer(size_t count)
         {
-            _ptr = reinterpret_cast<TElem*>(aligned_alloc(page_size, page_size));
+            _bytes = page_pool::block_size(count * sizeof(TElem));
+            _ptr = reinterpret_cast<TElem*>(page_pool::instance().acquire(_bytes));
             if (!_ptr) throw std::bad_alloc();
         }
 
-        explicit single_page_buffer(std::nullptr_t) {}
+        explicit page_buffer(std::nullptr_t) {}
 
-        ~single_page_buffer()
+        ~page_buffer()
         {
-            if (_ptr) aligned_free(reinterpret_cast<void*>(_ptr));
+            if (_ptr) page_pool::instance().release(reinterpret_cast<void*>(_ptr), _bytes);
         }
 
         // disable copy construct
-        single_page_buffer(const single_page_buffer&) = delete;
-        single_page_buffer& operator=(const single_page_buffer&) = delete;
+        page_buffer(const page_buffer&) = delete;
+        page_buffer& operator=(const page_buffer&) = delete;
 
-        inline single_page_buffer(single_page_buffer&& other) noexcept { std::swap(_ptr, other._ptr); }
-        inline single_page_buffer& operator=(single_page_buffer&& other) noexcept
+        inline page_buffer(page_buffer&& other) noexcept
+        {
+            std::swap(_ptr, other._ptr);
+            std::swap(_bytes, other._bytes);
+        }
+        inline page_buffer& operator=(page_buffer&& other) noexcept
         {
             if (_ptr) {
-                aligned_free(reinterpret_cast<void*>(_ptr));
+                page_pool::instance().release(reinterpret_cast<void*>(_ptr), _bytes);
                 _ptr = nullptr;
+                _bytes = 0;
             }
             std::swap(_ptr, other._ptr);
+            std::swap(_bytes, other._bytes);
             return *this;
         }
 
         inline TElem* get() const { return _ptr; }
-        inline size_t size() const { return _ptr ? (page_size / sizeof(TElem)) : 0; }
+        inline size_t size() const { return _bytes / sizeof(TElem); }
+    };
+
+    template <typename TElem>
+    requires std::is_trivial_v<TElem>
+    class single_page_buffer : public page_buffer<TElem>
+    {
+    public:
+        single_page_buffer() : page_buffer<TElem>(page_size / sizeof(TElem)) {}
+        explicit single_page_buffer(std::nullptr_t) : page_buffer<TElem>(nullptr) {}
+    };
+
+    // read-only mapping of a whole file, unmapped on destruction
+    class mapped_file
+    {
+        const char* _data = nullptr;
+        size_t _size = 0;
+        bool _valid = false;
+
+    public:
+        mapped_file() = default;
+        explicit mapped_file(const std::filesystem::path& path);
+        ~mapped_file();
+
+        // disable copy construct
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        inline mapped_file(mapped_file&& other) noexcept { swap(other); }
+        inline mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            mapped_file(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        inline void swap(mapped_file& other) noexcept
+        {
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+            std::swap(_valid, other._valid);
+        }
+
+        // an empty file maps successfully with a null data pointer
+        inline bool valid() const noexcept { return _valid; }
+        inline const char* data() const noexcept { return _data; }
+        inline size_t size() const noexcept { return _size; }
+        inline std::string_view view() const noexcept { return { _data, _size }; }
+    };
+
+    // reports changes to the files of a directory tree,
+    // with inotify on Linux, ReadDirectoryChangesW on Windows and by comparing timestamps elsewhere
+    class dir_watcher
+    {
+        struct impl;
+        std::unique_ptr<impl> _impl;
+
+    public:
+        dir_watcher();
+        explicit dir_watcher(const std::filesystem::path& dir);
+        ~dir_watcher();
+
+        // disable copy construct
+        dir_watcher(const dir_watcher&) = delete;
+        dir_watcher& operator=(const dir_watcher&) = delete;
+
+        dir_watcher(dir_watcher&&) noexcept;
+        dir_watcher& operator=(dir_watcher&&) noexcept;
+
+        bool valid() const noexcept;
+        // Blocks until something changes or the timeout expires, and returns the paths that were written,
+        // created, renamed or deleted since the previous call. A directory moved in, out or renamed may be
+        // reported by its own path only, without the files under it. When the system dropped events the
+        // watched directory itself is returned, meaning "rescan everything".
+        std::vector<std::filesystem::path> wait(std::chrono::milliseconds timeout);
     };
 } // namespace asst::platform
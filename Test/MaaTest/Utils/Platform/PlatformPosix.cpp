@@ -2,10 +2,35 @@
 #include "PlatformPosix.h"
 #include "Platform.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <csignal>
 #include <cstdlib>
+#include <cstring>
 #include <fcntl.h>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <poll.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
+#include <thread>
 #include <unistd.h>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#endif
+
+#include "Utils/Logger.hpp"
+
+extern char** environ;
 
 static size_t get_page_size()
 {
@@ -16,7 +41,8 @@ const size_t asst::platform::page_size = get_page_size();
 
 void* asst::platform::aligned_alloc(size_t len, size_t align)
 {
-    return ::aligned_alloc(len, align);
+    // C11 takes the alignment first, and wants len to be a multiple of it
+    return ::aligned_alloc(align, (len + align - 1) / align * align);
 }
 
 void asst::platform::aligned_free(void* ptr)
@@ -24,66 +50,1028 @@ void asst::platform::aligned_free(void* ptr)
     ::free(ptr);
 }
 
+static size_t get_huge_page_size()
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // "never" leaves madvise without effect
+    std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string mode;
+    std::getline(enabled, mode);
+    if (mode.find("[never]") != std::string::npos || mode.empty()) {
+        return 0;
+    }
+    std::ifstream pmd_size("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+    size_t size = 0;
+    if (!(pmd_size >> size) || size <= get_page_size() || (size & (size - 1)) != 0) {
+        return 0;
+    }
+    return size;
+#else
+    return 0;
+#endif
+}
+
+const size_t asst::platform::huge_page_size = get_huge_page_size();
+
+void* asst::platform::map_pages(size_t size, bool huge)
+{
+    constexpr int Prot = PROT_READ | PROT_WRITE;
+    constexpr int Flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (!huge || huge_page_size == 0) {
+        void* addr = ::mmap(nullptr, size, Prot, Flags, -1, 0);
+        return addr == MAP_FAILED ? nullptr : addr;
+    }
+
+    // mmap only aligns to pages: map one huge page more and cut off both ends
+    const size_t mapped_size = size + huge_page_size;
+    void* addr = ::mmap(nullptr, mapped_size, Prot, Flags, -1, 0);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+    const auto begin = reinterpret_cast<uintptr_t>(addr);
+    const uintptr_t aligned = (begin + huge_page_size - 1) & ~(uintptr_t(huge_page_size) - 1);
+    if (aligned != begin) {
+        ::munmap(addr, aligned - begin);
+    }
+    const size_t tail = begin + mapped_size - (aligned + size);
+    if (tail != 0) {
+        ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+#ifdef MADV_HUGEPAGE
+    ::madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+}
+
+void asst::platform::unmap_pages(void* ptr, size_t size)
+{
+    if (ptr) ::munmap(ptr, size);
+}
+
+asst::platform::mapped_file::mapped_file(const std::filesystem::path& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return;
+    }
+    auto size = static_cast<size_t>(st.st_size);
+    if (size != 0) {
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            return;
+        }
+        // parsers read front to back
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(addr);
+        _size = size;
+    }
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    _valid = true;
+}
+
+asst::platform::mapped_file::~mapped_file()
+{
+    if (_data) ::munmap(const_cast<char*>(_data), _size);
+}
+
+#ifdef __linux__
+
+struct asst::platform::dir_watcher::impl
+{
+    int fd = -1;
+    std::filesystem::path root;
+    std::unordered_map<int, std::filesystem::path> dirs;
+
+    ~impl()
+    {
+        if (fd >= 0) ::close(fd);
+    }
+
+    // inotify is not recursive, every directory of the tree needs its own watch
+    void add_tree(const std::filesystem::path& dir)
+    {
+        constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+        int wd = ::inotify_add_watch(fd, dir.c_str(), mask | IN_ONLYDIR);
+        if (wd < 0) {
+            return;
+        }
+        dirs[wd] = dir;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+                add_tree(entry.path());
+            }
+        }
+    }
+
+    // A directory moved away keeps its watches, and no IN_IGNORED comes for them: drop them by path.
+    void remove_tree(const std::filesystem::path& dir)
+    {
+        for (auto iter = dirs.begin(); iter != dirs.end();) {
+            const auto& watched = iter->second;
+            if (std::mismatch(dir.begin(), dir.end(), watched.begin(), watched.end()).first == dir.end()) {
+                ::inotify_rm_watch(fd, iter->first);
+                iter = dirs.erase(iter);
+            }
+            else {
+                ++iter;
+            }
+        }
+    }
+};
+
+asst::platform::dir_watcher::dir_watcher(const std::filesystem::path& dir) : _impl(std::make_unique<impl>())
+{
+    _impl->fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_impl->fd < 0) {
+        _impl.reset();
+        return;
+    }
+    _impl->root = dir;
+    _impl->add_tree(dir);
+    if (_impl->dirs.empty()) {
+        _impl.reset();
+    }
+}
+
+std::vector<std::filesystem::path> asst::platform::dir_watcher::wait(std::chrono::milliseconds timeout)
+{
+    std::vector<std::filesystem::path> changed;
+    if (!_impl) {
+        std::this_thread::sleep_for(timeout);
+        return changed;
+    }
+
+    pollfd pfd { _impl->fd, POLLIN, 0 };
+    if (::poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0) {
+        return changed;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t len = 0;
+    while ((len = ::read(_impl->fd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + len;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                changed.emplace_back(_impl->root);
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                _impl->dirs.erase(event->wd);
+                continue;
+            }
+            auto dir_iter = _impl->dirs.find(event->wd);
+            if (dir_iter == _impl->dirs.end() || event->len == 0) {
+                continue;
+            }
+            auto path = dir_iter->second / event->name;
+            if ((event->mask & IN_ISDIR) && (event->mask & IN_MOVED_FROM)) {
+                _impl->remove_tree(path);
+            }
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                _impl->add_tree(path);
+            }
+            // a created file is reported again once its writer closes it
+            if ((event->mask & IN_CREATE) && !(event->mask & IN_ISDIR)) {
+                continue;
+            }
+            changed.emplace_back(std::move(path));
+        }
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+#else
+
+struct asst::platform::dir_watcher::impl
+{
+    std::filesystem::path root;
+    std::unordered_map<std::string, std::filesystem::file_time_type> files;
+
+    std::unordered_map<std::string, std::filesystem::file_time_type> scan() const
+    {
+        std::unordered_map<std::string, std::filesystem::file_time_type> result;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root, ec)) {
+            if (entry.is_regular_file(ec)) {
+                result.emplace(entry.path().native(), entry.last_write_time(ec));
+            }
+        }
+        return result;
+    }
+};
+
+asst::platform::dir_watcher::dir_watcher(const std::filesystem::path& dir) : _impl(std::make_unique<impl>())
+{
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) {
+        _impl.reset();
+        return;
+    }
+    _impl->root = dir;
+    _impl->files = _impl->scan();
+}
+
+std::vector<std::filesystem::path> asst::platform::dir_watcher::wait(std::chrono::milliseconds timeout)
+{
+    std::vector<std::filesystem::path> changed;
+    std::this_thread::sleep_for(timeout);
+    if (!_impl) {
+        return changed;
+    }
+
+    auto files = _impl->scan();
+    for (const auto& [path, time] : files) {
+        auto iter = _impl->files.find(path);
+        if (iter == _impl->files.end() || iter->second != time) {
+            changed.emplace_back(path);
+        }
+    }
+    for (const auto& [path, time] : _impl->files) {
+        if (!files.contains(path)) {
+            changed.emplace_back(path);
+        }
+    }
+    _impl->files = std::move(files);
+
+    std::sort(changed.begin(), changed.end());
+    return changed;
+}
+
+#endif
+
+asst::platform::dir_watcher::dir_watcher() = default;
+asst::platform::dir_watcher::~dir_watcher() = default;
+asst::platform::dir_watcher::dir_watcher(dir_watcher&&) noexcept = default;
+asst::platform::dir_watcher& asst::platform::dir_watcher::operator=(dir_watcher&&) noexcept = default;
+
+bool asst::platform::dir_watcher::valid() const noexcept
+{
+    return _impl != nullptr;
+}
+
+namespace
+{
+    bool make_pipe(int fds[2])
+    {
+#ifdef __linux__
+        return ::pipe2(fds, O_CLOEXEC) == 0;
+#else
+        if (::pipe(fds) != 0) return false;
+        ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return true;
+#endif
+    }
+
+    // becomes readable when the process exits, -1 if the kernel is too old
+    int open_pidfd([[maybe_unused]] pid_t pid)
+    {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+        return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#else
+        return -1;
+#endif
+    }
+
+    // the child may exit without reading its stdin, which must not kill us with SIGPIPE
+    ssize_t write_no_sigpipe(int fd, const char* data, size_t len)
+    {
+        sigset_t pipe_set;
+        sigset_t old_set;
+        sigset_t pending;
+        sigemptyset(&pipe_set);
+        sigaddset(&pipe_set, SIGPIPE);
+        ::sigpending(&pending);
+        const bool was_pending = sigismember(&pending, SIGPIPE);
+        ::pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+        ssize_t ret = ::write(fd, data, len);
+        const int write_errno = errno;
+        if (ret < 0 && write_errno == EPIPE && !was_pending) {
+            // consume the SIGPIPE we caused, before unblocking it
+            struct timespec zero = {};
+            ::sigtimedwait(&pipe_set, nullptr, &zero);
+        }
+
+        ::pthread_sigmask(SIG_SETMASK, &old_set, nullptr);
+        errno = write_errno;
+        return ret;
+    }
+
+    void close_fd(int& fd)
+    {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    // words that are not programs: reserved words, the special builtins and the builtins that act on the shell
+    // itself, which have no binary in PATH or one that cannot do their job (cd, ulimit, ...)
+    constexpr std::string_view shell_words[] = {
+        // reserved words
+        "!", "{", "}", "case", "do", "done", "elif", "else", "esac", "fi", "for", "if", "in", "then", "until", "while",
+        // special builtins
+        ".", ":", "break", "continue", "eval", "exec", "exit", "export", "readonly", "return", "set", "shift", "times",
+        "trap", "unset",
+        // regular builtins on the shell environment
+        "alias", "bg", "cd", "command", "fg", "getopts", "hash", "jobs", "read", "type", "ulimit", "umask", "unalias",
+        "wait",
+    };
+
+    // whether cmdline uses anything beyond "program arg arg ...", which only sh can interpret
+    bool needs_shell(std::string_view cmdline)
+    {
+        if (cmdline.find_first_of("|&;<>()$`\\\"'*?[]#~{}!\n") != std::string_view::npos) {
+            return true;
+        }
+        const auto first_begin = std::min(cmdline.find_first_not_of(" \t"), cmdline.size());
+        const auto first_end = cmdline.find_first_of(" \t", first_begin);
+        const auto first = cmdline.substr(first_begin, first_end - first_begin);
+        // VAR=value program
+        if (first.find('=') != std::string_view::npos) {
+            return true;
+        }
+        return std::ranges::find(shell_words, first) != std::end(shell_words);
+    }
+
+    struct spawned_child
+    {
+        pid_t pid = -1;
+        // nonblocking, our ends of the child's stdin and stdout / stderr
+        int in_fd = -1;
+        int out_fd = -1;
+    };
+
+    // Starts cmdline with posix_spawn, which the libc implements with vfork / CLONE_VM: the page tables of this
+    // (possibly huge) process are never copied. Goes through `sh -c` only when cmdline needs it. The child leads
+    // its own process group, so that killing the group also stops whatever a shell started. If the program
+    // itself could not be executed, its errno goes to `spawn_error`.
+    bool spawn_child(const std::string& cmdline, spawned_child& child, int* spawn_error = nullptr)
+    {
+        constexpr int PIPE_READ = 0;
+        constexpr int PIPE_WRITE = 1;
+
+        int pipe_in[2] = { -1, -1 };
+        int pipe_out[2] = { -1, -1 };
+        if (!make_pipe(pipe_in) || !make_pipe(pipe_out)) {
+            asst::Log.error("Call `", cmdline, "` create pipe failed, error", errno);
+            close_fd(pipe_in[PIPE_READ]);
+            close_fd(pipe_in[PIPE_WRITE]);
+            return false;
+        }
+
+        std::vector<std::string> args;
+        if (needs_shell(cmdline)) {
+            args = { "sh", "-c", cmdline };
+        }
+        else {
+            for (size_t pos = cmdline.find_first_not_of(" \t"); pos != std::string::npos;) {
+                size_t end = cmdline.find_first_of(" \t", pos);
+                args.emplace_back(cmdline.substr(pos, end - pos));
+                pos = cmdline.find_first_not_of(" \t", end);
+            }
+        }
+        if (args.empty()) {
+            args = { "true" };
+        }
+        std::vector<char*> argv;
+        argv.reserve(args.size() + 1);
+        for (auto& arg : args) {
+            argv.emplace_back(arg.data());
+        }
+        argv.emplace_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawnattr_t attr;
+        ::posix_spawn_file_actions_init(&actions);
+        ::posix_spawnattr_init(&attr);
+        // the pipes themselves are O_CLOEXEC, the duplicates are not
+        ::posix_spawn_file_actions_adddup2(&actions, pipe_in[PIPE_READ], STDIN_FILENO);
+        ::posix_spawn_file_actions_adddup2(&actions, pipe_out[PIPE_WRITE], STDOUT_FILENO);
+        ::posix_spawn_file_actions_adddup2(&actions, pipe_out[PIPE_WRITE], STDERR_FILENO);
+        // a fresh signal state, whatever this process blocks or ignores
+        sigset_t no_signals;
+        sigset_t default_signals;
+        sigemptyset(&no_signals);
+        sigemptyset(&default_signals);
+        sigaddset(&default_signals, SIGPIPE);
+        ::posix_spawnattr_setsigmask(&attr, &no_signals);
+        ::posix_spawnattr_setsigdefault(&attr, &default_signals);
+        ::posix_spawnattr_setpgroup(&attr, 0);
+        ::posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+        pid_t pid = -1;
+        int spawn_ret = ::posix_spawnp(&pid, argv.front(), &actions, &attr, argv.data(), environ);
+        ::posix_spawn_file_actions_destroy(&actions);
+        ::posix_spawnattr_destroy(&attr);
+
+        // close unused file descriptors, these are for child only
+        close_fd(pipe_in[PIPE_READ]);
+        close_fd(pipe_out[PIPE_WRITE]);
+        if (spawn_ret != 0) {
+            asst::Log.error("Call `", cmdline, "` spawn failed, error", spawn_ret);
+            if (spawn_error) *spawn_error = spawn_ret;
+            close_fd(pipe_in[PIPE_WRITE]);
+            close_fd(pipe_out[PIPE_READ]);
+            return false;
+        }
+        ::fcntl(pipe_in[PIPE_WRITE], F_SETFL, O_NONBLOCK);
+        ::fcntl(pipe_out[PIPE_READ], F_SETFL, O_NONBLOCK);
+        child = { pid, pipe_in[PIPE_WRITE], pipe_out[PIPE_READ] };
+        return true;
+    }
+
+    // kills the whole process group of a spawned child and reaps it
+    void kill_child(pid_t pid)
+    {
+        int status = 0;
+        ::kill(-pid, SIGKILL);
+        ::waitpid(pid, &status, 0);
+    }
+
+    // wait time for poll(), -1 meaning forever; false when the deadline has passed
+    bool poll_timeout(std::chrono::steady_clock::time_point deadline, bool has_exit_flag, int& wait_ms)
+    {
+        using namespace std::chrono;
+        // a bool flag cannot wake us up, look at it this often
+        constexpr int ExitFlagCheckMs = 100;
+
+        wait_ms = -1;
+        if (deadline != steady_clock::time_point::max()) {
+            auto remaining = ceil<milliseconds>(deadline - steady_clock::now()).count();
+            if (remaining <= 0) {
+                return false;
+            }
+            wait_ms = static_cast<int>(std::min<long long>(remaining, INT_MAX));
+        }
+        if (has_exit_flag) {
+            wait_ms = wait_ms < 0 ? ExitFlagCheckMs : std::min(wait_ms, ExitFlagCheckMs);
+        }
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point deadline_of(std::chrono::milliseconds timeout)
+    {
+        return timeout.count() > 0 ? std::chrono::steady_clock::now() + timeout
+                                   : std::chrono::steady_clock::time_point::max();
+    }
+}
+
+namespace
+{
+    using asst::platform::command_options;
+    using asst::platform::command_result;
+
+    // Output, stdin and exit state of one spawned command. run_command drives a single one from its own poll
+    // loop, the reactor behind run_command_async many of them from one thread.
+    class running_command
+    {
+    public:
+        running_command(const command_options& options, std::string buffer)
+            : m_options(options), m_deadline(deadline_of(options.timeout))
+        {
+            m_result.output = std::move(buffer);
+            m_result.output.clear();
+        }
+        ~running_command()
+        {
+            if (m_child.pid >= 0 && !m_exited) kill_child(m_child.pid);
+            close_fd(m_child.in_fd);
+            close_fd(m_child.out_fd);
+            close_fd(m_pidfd);
+        }
+
+        // disable copy construct
+        running_command(const running_command&) = delete;
+        running_command& operator=(const running_command&) = delete;
+
+        bool start(const std::string& cmdline)
+        {
+            int spawn_error = 0;
+            if (!spawn_child(cmdline, m_child, &spawn_error)) {
+                if (spawn_error != 0) {
+                    // report it the way `sh -c` did before commands were spawned directly
+                    const size_t begin = cmdline.find_first_not_of(" \t");
+                    const std::string program =
+                        begin == std::string::npos
+                            ? std::string()
+                            : cmdline.substr(begin, cmdline.find_first_of(" \t", begin) - begin);
+                    m_result.exit_code = spawn_error == ENOENT ? 127 : 126;
+                    append(program + ": " + (spawn_error == ENOENT ? "not found" : std::strerror(spawn_error)) + "\n");
+                }
+                return false;
+            }
+            m_pidfd = open_pidfd(m_child.pid);
+            if (m_options.input.empty()) {
+                close_fd(m_child.in_fd);
+            }
+            return true;
+        }
+
+        int in_fd() const noexcept { return m_child.in_fd; }
+        int out_fd() const noexcept { return m_child.out_fd; }
+        int pidfd() const noexcept { return m_pidfd; }
+        bool exited() const noexcept { return m_exited; }
+        bool has_exit_flag() const noexcept { return m_options.exit_flag != nullptr; }
+        bool canceled() const noexcept { return m_options.exit_flag && *m_options.exit_flag; }
+        std::chrono::steady_clock::time_point deadline() const noexcept { return m_deadline; }
+
+        void on_readable()
+        {
+            if (!read_available()) close_fd(m_child.out_fd);
+        }
+
+        void on_writable()
+        {
+            const std::string_view input = m_options.input;
+            ssize_t write_num =
+                write_no_sigpipe(m_child.in_fd, input.data() + m_input_written, input.size() - m_input_written);
+            if (write_num > 0) m_input_written += static_cast<size_t>(write_num);
+            bool failed = write_num < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+            if (failed || m_input_written == input.size()) {
+                close_fd(m_child.in_fd);
+            }
+        }
+
+        // blocking once the pidfd said so, WNOHANG when there is no pidfd
+        void reap(bool wait)
+        {
+            pid_t ret = ::waitpid(m_child.pid, &m_status, wait ? 0 : WNOHANG);
+            m_exited = ret == m_child.pid || (ret < 0 && errno == ECHILD);
+        }
+
+        // true when the command is over: exited and its output read, or out of time
+        bool update()
+        {
+            if (m_exited) {
+                // grandchildren may still hold the pipe, only take what is already written
+                if (m_child.out_fd >= 0) read_available();
+                return true;
+            }
+            if (canceled()) {
+                m_result.canceled = true;
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= m_deadline) {
+                m_result.timed_out = true;
+                return true;
+            }
+            return false;
+        }
+
+        command_result finish()
+        {
+            if (m_exited) {
+                if (WIFEXITED(m_status)) {
+                    m_result.exit_code = WEXITSTATUS(m_status);
+                }
+                else if (WIFSIGNALED(m_status)) {
+                    m_result.exit_code = 128 + WTERMSIG(m_status);
+                }
+            }
+            else if (m_child.pid >= 0) {
+                kill_child(m_child.pid);
+                m_exited = true;
+            }
+            close_fd(m_child.in_fd);
+            close_fd(m_child.out_fd);
+            close_fd(m_pidfd);
+            return std::move(m_result);
+        }
+
+    private:
+        // reads what the pipe holds now, false once it reached EOF
+        bool read_available()
+        {
+            constexpr size_t PipeBuffSize = 4096;
+            char pipe_buffer[PipeBuffSize];
+            while (true) {
+                ssize_t read_num = ::read(m_child.out_fd, pipe_buffer, PipeBuffSize);
+                if (read_num > 0) {
+                    append(std::string_view(pipe_buffer, static_cast<size_t>(read_num)));
+                    continue;
+                }
+                if (read_num < 0 && errno == EINTR) continue;
+                return read_num < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            }
+        }
+
+        // past max_output the pipe is still drained, so that the command does not block on a full pipe
+        void append(std::string_view chunk)
+        {
+            const size_t max_output = m_options.max_output;
+            if (max_output != 0 && m_result.output.size() + chunk.size() > max_output) {
+                m_result.truncated = true;
+                chunk = chunk.substr(0, max_output - m_result.output.size());
+                if (chunk.empty()) return;
+            }
+            m_result.output.append(chunk);
+            if (m_options.on_output) m_options.on_output(chunk);
+        }
+
+        const command_options& m_options;
+        const std::chrono::steady_clock::time_point m_deadline;
+        command_result m_result;
+        spawned_child m_child;
+        int m_pidfd = -1;
+        size_t m_input_written = 0;
+        int m_status = 0;
+        bool m_exited = false;
+    };
+
+    // without pidfd the exit of the child is only seen by waitpid
+    constexpr int ReapCheckMs = 50;
+}
+
+asst::platform::command_result asst::platform::run_command(const std::string& cmdline,
+                                                           const command_options& options)
+{
+    running_command command(options, {});
+    if (!command.start(cmdline)) {
+        return command.finish();
+    }
+
+    while (!command.update()) {
+        int wait_ms = -1;
+        if (!poll_timeout(command.deadline(), command.has_exit_flag(), wait_ms)) {
+            // update() reports the timeout
+            continue;
+        }
+        if (command.pidfd() < 0) wait_ms = wait_ms < 0 ? ReapCheckMs : std::min(wait_ms, ReapCheckMs);
+
+        struct pollfd fds[3] = {};
+        nfds_t nfds = 0;
+        auto add_fd = [&](int fd, short events) {
+            if (fd < 0) return static_cast<struct pollfd*>(nullptr);
+            fds[nfds] = { fd, events, 0 };
+            return &fds[nfds++];
+        };
+        struct pollfd* out_poll = add_fd(command.out_fd(), POLLIN);
+        struct pollfd* in_poll = add_fd(command.in_fd(), POLLOUT);
+        struct pollfd* pid_poll = add_fd(command.pidfd(), POLLIN);
+
+        if (::poll(fds, nfds, wait_ms) < 0) {
+            if (errno == EINTR) continue;
+            Log.error("Call `", cmdline, "` poll failed, error", errno);
+            break;
+        }
+        if (out_poll && out_poll->revents) command.on_readable();
+        if (in_poll && in_poll->revents) command.on_writable();
+        if (pid_poll) {
+            if (pid_poll->revents) command.reap(true);
+        }
+        else {
+            command.reap(false);
+        }
+    }
+    return command.finish();
+}
+
+namespace
+{
+    // One thread that waits for all commands started by run_command_async with a single poll(). Commands are
+    // handed over through a queue and a self-pipe that wakes the poll up. The pollfd array is rebuilt on every
+    // wakeup, which is cheap for the few dozens of commands a device keeps in flight.
+    class command_reactor
+    {
+    public:
+        static command_reactor& instance()
+        {
+            static command_reactor reactor;
+            return reactor;
+        }
+
+        std::future<command_result> submit(const std::string& cmdline, command_options options, std::string buffer)
+        {
+            auto request = std::make_unique<pending>();
+            // the caller's string_view may not outlive this call
+            request->input.assign(options.input);
+            request->options = std::move(options);
+            request->options.input = request->input;
+            request->command = std::make_unique<running_command>(request->options, std::move(buffer));
+            auto future = request->promise.get_future();
+
+            if (!request->command->start(cmdline)) {
+                request->promise.set_value(request->command->finish());
+                return future;
+            }
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (!m_thread.joinable()) {
+                    m_thread = std::thread(&command_reactor::run, this);
+                }
+                m_queue.emplace_back(std::move(request));
+            }
+            wake();
+            return future;
+        }
+
+    private:
+        struct pending
+        {
+            std::string input;
+            command_options options;
+            std::unique_ptr<running_command> command;
+            std::promise<command_result> promise;
+        };
+
+        command_reactor()
+        {
+            if (!make_pipe(m_wake_pipe)) {
+                asst::Log.error("command reactor create pipe failed, error", errno);
+                return;
+            }
+            ::fcntl(m_wake_pipe[0], F_SETFL, O_NONBLOCK);
+            ::fcntl(m_wake_pipe[1], F_SETFL, O_NONBLOCK);
+        }
+        ~command_reactor()
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            wake();
+            if (m_thread.joinable()) m_thread.join();
+            close_fd(m_wake_pipe[0]);
+            close_fd(m_wake_pipe[1]);
+        }
+
+        void wake()
+        {
+            if (m_wake_pipe[1] < 0) return;
+            char byte = 0;
+            // a full pipe already means "wake up"
+            [[maybe_unused]] auto ret = ::write(m_wake_pipe[1], &byte, 1);
+        }
+
+        void run()
+        {
+            std::vector<std::unique_ptr<pending>> running;
+            std::vector<struct pollfd> fds;
+            // for every entry of fds, the command it belongs to
+            std::vector<size_t> owners;
+
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    if (m_stop) break;
+                    std::ranges::move(m_queue, std::back_inserter(running));
+                    m_queue.clear();
+                }
+
+                // complete what is over, then collect what to wait for
+                std::erase_if(running, [](auto& request) {
+                    if (!request->command->update()) return false;
+                    request->promise.set_value(request->command->finish());
+                    return true;
+                });
+
+                int wait_ms = -1;
+                fds.clear();
+                owners.clear();
+                fds.push_back({ m_wake_pipe[0], POLLIN, 0 });
+                owners.push_back(running.size());
+                for (size_t i = 0; i < running.size(); ++i) {
+                    const running_command& command = *running[i]->command;
+                    int command_wait = -1;
+                    if (!poll_timeout(command.deadline(), command.has_exit_flag(), command_wait)) {
+                        command_wait = 0;
+                    }
+                    if (command.pidfd() < 0) {
+                        command_wait = command_wait < 0 ? ReapCheckMs : std::min(command_wait, ReapCheckMs);
+                    }
+                    if (command_wait >= 0) wait_ms = wait_ms < 0 ? command_wait : std::min(wait_ms, command_wait);
+
+                    for (auto [fd, events] : { std::pair { command.out_fd(), POLLIN },
+                                               std::pair { command.in_fd(), POLLOUT },
+                                               std::pair { command.pidfd(), POLLIN } }) {
+                        if (fd < 0) continue;
+                        fds.push_back({ fd, static_cast<short>(events), 0 });
+                        owners.push_back(i);
+                    }
+                }
+
+                if (::poll(fds.data(), static_cast<nfds_t>(fds.size()), wait_ms) < 0) {
+                    if (errno != EINTR) {
+                        asst::Log.error("command reactor poll failed, error", errno);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(ReapCheckMs));
+                    }
+                    continue;
+                }
+                if (fds.front().revents) {
+                    char drain[64];
+                    while (::read(m_wake_pipe[0], drain, sizeof(drain)) > 0) {}
+                }
+                for (size_t i = 1; i < fds.size(); ++i) {
+                    if (!fds[i].revents) continue;
+                    running_command& command = *running[owners[i]]->command;
+                    if (fds[i].fd == command.out_fd()) command.on_readable();
+                    else if (fds[i].fd == command.in_fd()) command.on_writable();
+                    else if (fds[i].fd == command.pidfd()) command.reap(true);
+                }
+                for (auto& request : running) {
+                    if (request->command->pidfd() < 0 && !request->command->exited()) request->command->reap(false);
+                }
+            }
+
+            // shutting down with the process: whatever still runs is killed
+            std::unique_lock<std::mutex> lock(m_mutex);
+            std::ranges::move(m_queue, std::back_inserter(running));
+            m_queue.clear();
+            for (auto& request : running) {
+                request->promise.set_value(request->command->finish());
+            }
+        }
+
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<pending>> m_queue;
+        bool m_stop = false;
+        int m_wake_pipe[2] = { -1, -1 };
+        std::thread m_thread;
+    };
+}
+
+std::future<asst::platform::command_result> asst::platform::run_command_async(const std::string& cmdline,
+                                                                              command_options options,
+                                                                              std::string buffer)
+{
+    return command_reactor::instance().submit(cmdline, std::move(options), std::move(buffer));
+}
+
 std::string asst::platform::call_command(const std::string& cmdline, bool* exit_flag)
+{
+    command_options options;
+    options.exit_flag = exit_flag;
+    return run_command(cmdline, options).output;
+}
+
+struct asst::platform::shell_session::impl
+{
+    std::mutex mutex;
+    spawned_child shell;
+    uint64_t counter = 0;
+
+    ~impl() { stop(); }
+
+    void stop()
+    {
+        if (shell.pid < 0) return;
+        close_fd(shell.in_fd);
+        close_fd(shell.out_fd);
+        kill_child(shell.pid);
+        shell.pid = -1;
+    }
+
+    // writes all of data, false if the shell is gone or the deadline passed
+    bool write_all(std::string_view data, std::chrono::steady_clock::time_point deadline, bool* exit_flag)
+    {
+        while (!data.empty()) {
+            ssize_t write_num = write_no_sigpipe(shell.in_fd, data.data(), data.size());
+            if (write_num > 0) {
+                data.remove_prefix(static_cast<size_t>(write_num));
+                continue;
+            }
+            if (write_num < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return false;
+            }
+            int wait_ms = -1;
+            if (!poll_timeout(deadline, exit_flag != nullptr, wait_ms) || (exit_flag && *exit_flag)) {
+                return false;
+            }
+            struct pollfd fd = { shell.in_fd, POLLOUT, 0 };
+            ::poll(&fd, 1, wait_ms);
+        }
+        return true;
+    }
+};
+
+asst::platform::shell_session::shell_session() : _impl(std::make_unique<impl>()) {}
+asst::platform::shell_session::~shell_session() = default;
+asst::platform::shell_session::shell_session(shell_session&&) noexcept = default;
+asst::platform::shell_session& asst::platform::shell_session::operator=(shell_session&&) noexcept = default;
+
+asst::platform::command_result asst::platform::shell_session::run(const std::string& cmdline,
+                                                                  const command_options& options)
 {
     constexpr int PipeBuffSize = 4096;
-    std::string pipe_str;
-    auto pipe_buffer = std::make_unique<char[]>(PipeBuffSize);
 
-    constexpr static int PIPE_READ = 0;
-    constexpr static int PIPE_WRITE = 1;
-    int pipe_in[2] = { 0 };
-    int pipe_out[2] = { 0 };
-    int pipe_in_ret = pipe(pipe_in);
-    int pipe_out_ret = pipe(pipe_out);
-    if (pipe_in_ret != 0 || pipe_out_ret != 0) {
-        return {};
-    }
-    ::fcntl(pipe_out[PIPE_READ], F_SETFL, O_NONBLOCK);
-    int exit_ret = 0;
-    int child = ::fork();
-    if (child == 0) {
-        // child process
-        ::dup2(pipe_in[PIPE_READ], STDIN_FILENO);
-        ::dup2(pipe_out[PIPE_WRITE], STDOUT_FILENO);
-        ::dup2(pipe_out[PIPE_WRITE], STDERR_FILENO);
-
-        // all these are for use by parent only
-        ::close(pipe_in[PIPE_READ]);
-        ::close(pipe_in[PIPE_WRITE]);
-        ::close(pipe_out[PIPE_READ]);
-        ::close(pipe_out[PIPE_WRITE]);
-
-        exit_ret = execlp("sh", "sh", "-c", cmdline.c_str(), nullptr);
-        ::exit(exit_ret);
-    }
-    else if (child > 0) {
-        // parent process
+    command_result result;
+    std::unique_lock<std::mutex> lock(_impl->mutex);
+    auto& shell = _impl->shell;
+    if (shell.pid < 0 && !spawn_child("sh", shell)) {
+        return result;
+    }
 
-        // close unused file descriptors, these are for child only
-        ::close(pipe_in[PIPE_READ]);
-        ::close(pipe_out[PIPE_WRITE]);
+    // The command ends with a line only this call can produce, carrying its exit status. The newline before it
+    // is ours, so that the marker starts a line even when the output does not end with one. The command is
+    // handed to `command eval` as one quoted word: a syntax error in it, such as an unbalanced quote, fails
+    // that command with a nonzero status instead of swallowing the marker, and does not end the shell.
+    const std::string marker =
+        "__asst_done_" + std::to_string(shell.pid) + "_" + std::to_string(++_impl->counter) + "__ ";
+    std::string script = "{ command eval '";
+    for (char ch : cmdline) {
+        if (ch == '\'') script += "'\\''";
+        else script += ch;
+    }
+    script += "'\n} </dev/null 2>&1; printf '\\n%s%d\\n' '" + marker + "' \"$?\"\n";
+    const std::string line_marker = "\n" + marker;
 
-        do {
-            ssize_t read_num = ::read(pipe_out[PIPE_READ], pipe_buffer.get(), PipeBuffSize);
+    const auto deadline = deadline_of(options.timeout);
+    if (!_impl->write_all(script, deadline, options.exit_flag)) {
+        result.timed_out = std::chrono::steady_clock::now() >= deadline;
+        result.canceled = !result.timed_out;
+        _impl->stop();
+        return result;
+    }
 
-            while (read_num > 0) {
-                pipe_str.append(pipe_buffer.get(), pipe_buffer.get() + read_num);
-                read_num = ::read(pipe_out[PIPE_READ], pipe_buffer.get(), PipeBuffSize);
-            };
-        } while (::waitpid(child, &exit_ret, WNOHANG) == 0 && !(exit_flag && *exit_flag));
+    // past max_output the pipe is still drained, as in run_command
+    auto append = [&](std::string_view chunk) {
+        if (options.max_output != 0 && result.output.size() + chunk.size() > options.max_output) {
+            result.truncated = true;
+            chunk = chunk.substr(0, options.max_output - result.output.size());
+            if (chunk.empty()) return;
+        }
+        result.output.append(chunk);
+        if (options.on_output) options.on_output(chunk);
+    };
 
-        ::close(pipe_in[PIPE_WRITE]);
-        ::close(pipe_out[PIPE_READ]);
+    auto pipe_buffer = std::make_unique<char[]>(PipeBuffSize);
+    // output not passed to append yet: at most the tail that may be the start of the marker, then the status
+    std::string pending;
+    size_t marker_pos = std::string::npos;
+    bool shell_gone = false;
+    while (marker_pos == std::string::npos) {
+        if (options.exit_flag && *options.exit_flag) {
+            result.canceled = true;
+            break;
+        }
+        int wait_ms = -1;
+        if (!poll_timeout(deadline, options.exit_flag != nullptr, wait_ms)) {
+            result.timed_out = true;
+            break;
+        }
+        struct pollfd fd = { shell.out_fd, POLLIN, 0 };
+        if (::poll(&fd, 1, wait_ms) < 0 && errno != EINTR) {
+            Log.error("Call `", cmdline, "` poll failed, error", errno);
+            break;
+        }
+        ssize_t read_num = ::read(shell.out_fd, pipe_buffer.get(), PipeBuffSize);
+        if (read_num == 0 || (read_num < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            // the command made the shell exit
+            shell_gone = true;
+            break;
+        }
+        if (read_num < 0) {
+            continue;
+        }
+        pending.append(pipe_buffer.get(), static_cast<size_t>(read_num));
+        marker_pos = pending.find(line_marker);
+
+        size_t safe_end = marker_pos;
+        if (marker_pos == std::string::npos) {
+            safe_end = pending.size() >= line_marker.size() ? pending.size() - line_marker.size() + 1 : 0;
+        }
+        append(std::string_view(pending).substr(0, safe_end));
+        pending.erase(0, safe_end);
+        if (marker_pos != std::string::npos) {
+            marker_pos = 0;
+        }
     }
-    else {
-        // failed to create child process
-        ::close(pipe_in[PIPE_READ]);
-        ::close(pipe_in[PIPE_WRITE]);
-        ::close(pipe_out[PIPE_READ]);
-        ::close(pipe_out[PIPE_WRITE]);
+
+    if (marker_pos != std::string::npos) {
+        // wait for the rest of the status line
+        while (pending.find('\n', line_marker.size()) == std::string::npos) {
+            int wait_ms = -1;
+            struct pollfd fd = { shell.out_fd, POLLIN, 0 };
+            if (!poll_timeout(deadline, false, wait_ms) || ::poll(&fd, 1, wait_ms) < 0) break;
+            ssize_t read_num = ::read(shell.out_fd, pipe_buffer.get(), PipeBuffSize);
+            if (read_num > 0) pending.append(pipe_buffer.get(), static_cast<size_t>(read_num));
+            else if (read_num == 0) break;
+        }
+        result.exit_code = std::atoi(pending.c_str() + line_marker.size());
+        return result;
+    }
+
+    append(pending);
+    if (!shell_gone) {
+        Log.warn("Call `", cmdline, "` did not finish, restarting the shell");
     }
-    return pipe_str;
+    _impl->stop();
+    return result;
 }
 
 #endif
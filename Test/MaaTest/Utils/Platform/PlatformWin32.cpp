@@ -2,9 +2,12 @@
 #include "PlatformWin32.h"
 #include "Platform.h"
 
+#include <algorithm>
 #include <atomic>
 #include <format>
+#include <future>
 #include <mbctype.h>
+#include <thread>
 
 #include "Utils/Logger.hpp"
 #include "Utils/StringMisc.hpp"
@@ -28,6 +31,144 @@ void asst::platform::aligned_free(void* ptr)
     _aligned_free(ptr);
 }
 
+// large pages need SeLockMemoryPrivilege and cannot be paged out, ordinary pages are used instead
+const size_t asst::platform::huge_page_size = 0;
+
+void* asst::platform::map_pages(size_t size, [[maybe_unused]] bool huge)
+{
+    return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+void asst::platform::unmap_pages(void* ptr, [[maybe_unused]] size_t size)
+{
+    if (ptr) VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+asst::platform::mapped_file::mapped_file(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+    LARGE_INTEGER size {};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return;
+    }
+    if (size.QuadPart != 0) {
+        // CreateFileMapping fails on empty files
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return;
+        }
+        void* addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // the view keeps the mapping and file alive
+        CloseHandle(mapping);
+        if (!addr) {
+            CloseHandle(file);
+            return;
+        }
+        _data = static_cast<const char*>(addr);
+        _size = static_cast<size_t>(size.QuadPart);
+    }
+    CloseHandle(file);
+    _valid = true;
+}
+
+asst::platform::mapped_file::~mapped_file()
+{
+    if (_data) UnmapViewOfFile(_data);
+}
+
+struct asst::platform::dir_watcher::impl
+{
+    HANDLE dir = INVALID_HANDLE_VALUE;
+    HANDLE event = nullptr;
+    OVERLAPPED overlapped {};
+    std::filesystem::path root;
+    alignas(DWORD) char buffer[64 * 1024] {};
+
+    ~impl()
+    {
+        if (dir != INVALID_HANDLE_VALUE) {
+            CancelIoEx(dir, &overlapped);
+            DWORD bytes = 0;
+            GetOverlappedResult(dir, &overlapped, &bytes, TRUE);
+            CloseHandle(dir);
+        }
+        if (event) CloseHandle(event);
+    }
+
+    bool start_read()
+    {
+        ResetEvent(event);
+        constexpr DWORD filter =
+            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+        return ReadDirectoryChangesW(dir, buffer, sizeof(buffer), TRUE, filter, nullptr, &overlapped, nullptr);
+    }
+};
+
+asst::platform::dir_watcher::dir_watcher(const std::filesystem::path& dir) : _impl(std::make_unique<impl>())
+{
+    _impl->root = dir;
+    _impl->dir = CreateFileW(dir.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    _impl->event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (_impl->dir == INVALID_HANDLE_VALUE || !_impl->event) {
+        _impl.reset();
+        return;
+    }
+    _impl->overlapped.hEvent = _impl->event;
+    if (!_impl->start_read()) {
+        _impl.reset();
+    }
+}
+
+std::vector<std::filesystem::path> asst::platform::dir_watcher::wait(std::chrono::milliseconds timeout)
+{
+    std::vector<std::filesystem::path> changed;
+    if (!_impl) {
+        Sleep(static_cast<DWORD>(timeout.count()));
+        return changed;
+    }
+    if (WaitForSingleObject(_impl->event, static_cast<DWORD>(timeout.count())) != WAIT_OBJECT_0) {
+        return changed;
+    }
+
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(_impl->dir, &_impl->overlapped, &bytes, FALSE) || bytes == 0) {
+        // the buffer overflowed, the changes are lost
+        changed.emplace_back(_impl->root);
+    }
+    else {
+        for (const char* ptr = _impl->buffer;;) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(ptr);
+            changed.emplace_back(_impl->root /
+                                 std::wstring_view(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+            if (info->NextEntryOffset == 0) break;
+            ptr += info->NextEntryOffset;
+        }
+    }
+    if (!_impl->start_read()) {
+        Log.error("ReadDirectoryChangesW failed, error", GetLastError());
+        _impl.reset();
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+asst::platform::dir_watcher::dir_watcher() = default;
+asst::platform::dir_watcher::~dir_watcher() = default;
+asst::platform::dir_watcher::dir_watcher(dir_watcher&&) noexcept = default;
+asst::platform::dir_watcher& asst::platform::dir_watcher::operator=(dir_watcher&&) noexcept = default;
+
+bool asst::platform::dir_watcher::valid() const noexcept
+{
+    return _impl != nullptr;
+}
+
 bool asst::win32::CreateOverlappablePipe(HANDLE* read, HANDLE* write, SECURITY_ATTRIBUTES* secattr_read,
                                          SECURITY_ATTRIBUTES* secattr_write, DWORD bufsize, bool overlapped_read,
                                          bool overlapped_write)
@@ -120,57 +261,126 @@ std::string asst::platform::from_osstring(const os_string& os_str)
     return result;
 }
 
-std::string asst::platform::call_command(const std::string& cmdline, bool* exit_flag)
+// collects the output into buffer, reusing its capacity
+static asst::platform::command_result run_command_into(const std::string& cmdline,
+                                                       const asst::platform::command_options& options,
+                                                       std::string buffer)
 {
+    using namespace std::chrono;
+
     constexpr int PipeBuffSize = 4096;
+    // a bool flag cannot wake us up, look at it this often
+    constexpr DWORD ExitFlagCheckMs = 100;
+
+    asst::platform::command_result result;
+    result.output = std::move(buffer);
+    result.output.clear();
     auto pipe_buffer = std::make_unique<char[]>(PipeBuffSize);
-    std::string pipe_str;
 
     HANDLE pipe_parent_read = INVALID_HANDLE_VALUE, pipe_child_write = INVALID_HANDLE_VALUE;
+    HANDLE pipe_child_read = INVALID_HANDLE_VALUE, pipe_parent_write = INVALID_HANDLE_VALUE;
     SECURITY_ATTRIBUTES sa_inherit { .nLength = sizeof(SECURITY_ATTRIBUTES), .bInheritHandle = TRUE };
     if (!asst::win32::CreateOverlappablePipe(&pipe_parent_read, &pipe_child_write, nullptr, &sa_inherit, PipeBuffSize,
                                              true, false)) {
         DWORD err = GetLastError();
         asst::Log.error("CreateOverlappablePipe failed, err", err);
-        return {};
+        return result;
+    }
+    const bool has_input = !options.input.empty();
+    if (has_input && !asst::win32::CreateOverlappablePipe(&pipe_child_read, &pipe_parent_write, &sa_inherit, nullptr,
+                                                          PipeBuffSize, false, true)) {
+        DWORD err = GetLastError();
+        asst::Log.error("CreateOverlappablePipe failed, err", err);
+        CloseHandle(pipe_parent_read);
+        CloseHandle(pipe_child_write);
+        return result;
     }
 
     STARTUPINFOW si {};
     si.cb = sizeof(STARTUPINFOW);
     si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
     si.wShowWindow = SW_HIDE;
+    si.hStdInput = has_input ? pipe_child_read : nullptr;
     si.hStdOutput = pipe_child_write;
     si.hStdError = pipe_child_write;
     ASST_AUTO_DEDUCED_ZERO_INIT_START
     PROCESS_INFORMATION process_info = { nullptr };
     ASST_AUTO_DEDUCED_ZERO_INIT_END
 
-    auto cmdline_osstr = to_osstring(cmdline);
+    auto cmdline_osstr = asst::platform::to_osstring(cmdline);
     BOOL create_ret =
         CreateProcessW(nullptr, cmdline_osstr.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &si, &process_info);
+    CloseHandle(pipe_child_write);
+    if (has_input) CloseHandle(pipe_child_read);
     if (!create_ret) {
         DWORD err = GetLastError();
-        Log.error("Call `", cmdline, "` create process failed, ret", create_ret, "error code:", err);
-        return {};
+        asst::Log.error("Call `", cmdline, "` create process failed, ret", create_ret, "error code:", err);
+        CloseHandle(pipe_parent_read);
+        if (has_input) CloseHandle(pipe_parent_write);
+        return result;
     }
 
-    CloseHandle(pipe_child_write);
-
     std::vector<HANDLE> wait_handles;
-    wait_handles.reserve(2);
+    wait_handles.reserve(3);
     bool process_running = true;
     bool pipe_eof = false;
 
     OVERLAPPED pipeov { .hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr) };
-    (void)ReadFile(pipe_parent_read, pipe_buffer.get(), PipeBuffSize, nullptr, &pipeov);
+    auto start_read = [&]() {
+        if (!ReadFile(pipe_parent_read, pipe_buffer.get(), PipeBuffSize, nullptr, &pipeov) &&
+            GetLastError() != ERROR_IO_PENDING) {
+            // EOF or broken pipe, no read is pending and the event will never be signaled
+            pipe_eof = true;
+        }
+    };
+    start_read();
+
+    // stdin is written in overlapped chunks, so a child that does not read it cannot block us
+    OVERLAPPED writeov { .hEvent = has_input ? CreateEventW(nullptr, TRUE, FALSE, nullptr) : nullptr };
+    size_t input_written = 0;
+    bool writing = false;
+    auto close_input = [&]() {
+        if (pipe_parent_write != INVALID_HANDLE_VALUE) {
+            CloseHandle(pipe_parent_write);
+            pipe_parent_write = INVALID_HANDLE_VALUE;
+        }
+        writing = false;
+    };
+    auto write_input = [&]() {
+        const DWORD len = static_cast<DWORD>(std::min<size_t>(options.input.size() - input_written, PipeBuffSize));
+        if (!WriteFile(pipe_parent_write, options.input.data() + input_written, len, nullptr, &writeov) &&
+            GetLastError() != ERROR_IO_PENDING) {
+            close_input();
+            return;
+        }
+        writing = true;
+    };
+    if (has_input) write_input();
+
+    const auto deadline = options.timeout.count() > 0 ? steady_clock::now() + options.timeout
+                                                      : steady_clock::time_point::max();
+    while (process_running || !pipe_eof) {
+        if (options.exit_flag && *options.exit_flag) {
+            result.canceled = true;
+            break;
+        }
+        DWORD wait_ms = INFINITE;
+        if (deadline != steady_clock::time_point::max()) {
+            auto remaining = ceil<milliseconds>(deadline - steady_clock::now()).count();
+            if (remaining <= 0) {
+                result.timed_out = true;
+                break;
+            }
+            wait_ms = static_cast<DWORD>(std::min<long long>(remaining, INFINITE - 1));
+        }
+        if (options.exit_flag) wait_ms = std::min(wait_ms, ExitFlagCheckMs);
 
-    while (!(exit_flag && *exit_flag)) {
         wait_handles.clear();
         if (process_running) wait_handles.push_back(process_info.hProcess);
         if (!pipe_eof) wait_handles.push_back(pipeov.hEvent);
-        if (wait_handles.empty()) break;
+        if (writing) wait_handles.push_back(writeov.hEvent);
         auto wait_result =
-            WaitForMultipleObjectsEx((DWORD)wait_handles.size(), wait_handles.data(), FALSE, INFINITE, TRUE);
+            WaitForMultipleObjectsEx((DWORD)wait_handles.size(), wait_handles.data(), FALSE, wait_ms, TRUE);
         HANDLE signaled_object = INVALID_HANDLE_VALUE;
         if (wait_result >= WAIT_OBJECT_0 && wait_result < WAIT_OBJECT_0 + wait_handles.size()) {
             signaled_object = wait_handles[(size_t)wait_result - WAIT_OBJECT_0];
@@ -182,7 +392,7 @@ std::string asst::platform::call_command(const std::string& cmdline, bool* exit_
             // something bad happened
             DWORD err = GetLastError();
             // throw std::system_error(std::error_code(err, std::system_category()));
-            Log.error(__FUNCTION__, "A fatal error occurred", err);
+            asst::Log.error(__FUNCTION__, "A fatal error occurred", err);
             break;
         }
 
@@ -193,8 +403,15 @@ std::string asst::platform::call_command(const std::string& cmdline, bool* exit_
             // pipe read
             DWORD len = 0;
             if (GetOverlappedResult(pipe_parent_read, &pipeov, &len, FALSE)) {
-                pipe_str.insert(pipe_str.end(), pipe_buffer.get(), pipe_buffer.get() + len);
-                (void)ReadFile(pipe_parent_read, pipe_buffer.get(), PipeBuffSize, nullptr, &pipeov);
+                std::string_view chunk(pipe_buffer.get(), len);
+                // past max_output the pipe is still drained, so that the command does not block on a full pipe
+                if (options.max_output != 0 && result.output.size() + chunk.size() > options.max_output) {
+                    result.truncated = true;
+                    chunk = chunk.substr(0, options.max_output - result.output.size());
+                }
+                result.output.append(chunk);
+                if (options.on_output && !chunk.empty()) options.on_output(chunk);
+                start_read();
             }
             else {
                 DWORD err = GetLastError();
@@ -203,17 +420,109 @@ std::string asst::platform::call_command(const std::string& cmdline, bool* exit_
                 }
             }
         }
+        else if (signaled_object == writeov.hEvent) {
+            DWORD len = 0;
+            if (!GetOverlappedResult(pipe_parent_write, &writeov, &len, FALSE)) {
+                close_input();
+                continue;
+            }
+            input_written += len;
+            if (input_written == options.input.size()) {
+                close_input();
+            }
+            else {
+                write_input();
+            }
+        }
     }
 
-    DWORD exit_ret = 0;
-    GetExitCodeProcess(process_info.hProcess, &exit_ret);
+    if (process_running) {
+        TerminateProcess(process_info.hProcess, 1);
+        WaitForSingleObject(process_info.hProcess, INFINITE);
+    }
+    else {
+        DWORD exit_ret = 0;
+        GetExitCodeProcess(process_info.hProcess, &exit_ret);
+        result.exit_code = static_cast<int>(exit_ret);
+    }
+    // pending overlapped operations must finish before their buffers go away
+    DWORD ignored = 0;
+    if (!pipe_eof) {
+        CancelIoEx(pipe_parent_read, &pipeov);
+        GetOverlappedResult(pipe_parent_read, &pipeov, &ignored, TRUE);
+    }
+    if (writing) {
+        CancelIoEx(pipe_parent_write, &writeov);
+        GetOverlappedResult(pipe_parent_write, &writeov, &ignored, TRUE);
+    }
+    close_input();
     CloseHandle(process_info.hProcess);
     CloseHandle(process_info.hThread);
     CloseHandle(pipe_parent_read);
     if (pipeov.hEvent) {
         CloseHandle(pipeov.hEvent);
     }
-    return pipe_str;
+    if (writeov.hEvent) {
+        CloseHandle(writeov.hEvent);
+    }
+    return result;
+}
+
+asst::platform::command_result asst::platform::run_command(const std::string& cmdline,
+                                                           const command_options& options)
+{
+    return run_command_into(cmdline, options, {});
+}
+
+// Every command is waited for by a thread of its own, which sleeps in WaitForMultipleObjectsEx like run_command.
+std::future<asst::platform::command_result> asst::platform::run_command_async(const std::string& cmdline,
+                                                                              command_options options,
+                                                                              std::string buffer)
+{
+    struct request
+    {
+        std::string cmdline;
+        std::string input;
+        command_options options;
+        std::string buffer;
+        std::promise<command_result> promise;
+    };
+    auto req = std::make_unique<request>();
+    req->cmdline = cmdline;
+    // the caller's string_view may not outlive this call
+    req->input.assign(options.input);
+    req->options = std::move(options);
+    req->options.input = req->input;
+    req->buffer = std::move(buffer);
+    auto future = req->promise.get_future();
+
+    std::thread([req = std::move(req)]() {
+        req->promise.set_value(run_command_into(req->cmdline, req->options, std::move(req->buffer)));
+    }).detach();
+    return future;
+}
+
+std::string asst::platform::call_command(const std::string& cmdline, bool* exit_flag)
+{
+    command_options options;
+    options.exit_flag = exit_flag;
+    return run_command(cmdline, options).output;
+}
+
+// cmd.exe has no way to mark the end of the output of a command, every command gets its own process
+struct asst::platform::shell_session::impl
+{
+};
+
+asst::platform::shell_session::shell_session() : _impl(std::make_unique<impl>()) {}
+asst::platform::shell_session::~shell_session() = default;
+asst::platform::shell_session::shell_session(shell_session&&) noexcept = default;
+asst::platform::shell_session& asst::platform::shell_session::operator=(shell_session&&) noexcept = default;
+
+asst::platform::command_result asst::platform::shell_session::run(const std::string& cmdline,
+                                                                  const command_options& options)
+{
+    return run_command(cmdline, options);
 }
 
 #define REPARSE_MOUNTPOINT_HEADER_SIZE 8
@@ -1,16 +1,20 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <charconv>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <iterator>
+#include <limits>
 #include <locale>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "Meta.hpp"
 #include "Ranges.hpp"
@@ -112,6 +116,228 @@ namespace asst::utils
         return result;
     }
 
+    // Aho-Corasick automaton over bytes: finds every occurrence of any of the patterns in one pass, with one table
+    // lookup per input byte. Bytes that appear in no pattern share one column of the table, so it stays small
+    // for utf8 patterns too. Empty patterns never match.
+    class AhoCorasick
+    {
+    public:
+        static constexpr uint32_t NoPattern = std::numeric_limits<uint32_t>::max();
+
+        AhoCorasick() = default;
+        explicit AhoCorasick(const std::vector<std::string_view>& patterns) { build(patterns); }
+
+        bool empty() const noexcept { return m_nodes.size() <= 1; }
+        size_t pattern_count() const noexcept { return m_lengths.size(); }
+        size_t pattern_length(uint32_t pattern) const noexcept { return m_lengths[pattern]; }
+
+        // Calls on_match(end, pattern) for every occurrence, `end` being one past its last byte, in order of
+        // `end`; for duplicated patterns only the first index is reported. Stops when on_match returns false.
+        template <typename MatchF>
+        void scan(std::string_view str, MatchF&& on_match) const
+        {
+            if (empty()) {
+                return;
+            }
+            uint32_t state = 0;
+            for (size_t pos = 0; pos < str.size(); ++pos) {
+                state = m_next[state * m_class_count + m_classes[static_cast<uint8_t>(str[pos])]];
+                for (uint32_t node = m_nodes[state].output; node != NoPattern; node = m_nodes[node].next_output) {
+                    if (!on_match(pos + 1, m_nodes[node].pattern)) {
+                        return;
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Node
+        {
+            // trie children by byte class, only while building
+            std::vector<std::pair<uint8_t, uint32_t>> children;
+            uint32_t fail = 0;
+            // the pattern ending at this node, the first one for duplicates
+            uint32_t pattern = NoPattern;
+            // this node if it ends a pattern, else the nearest such node along the fail links
+            uint32_t output = NoPattern;
+            // the next node ending a pattern along the fail links of `output`
+            uint32_t next_output = NoPattern;
+        };
+
+        void build(const std::vector<std::string_view>& patterns)
+        {
+            m_lengths.clear();
+            for (std::string_view pattern : patterns) {
+                m_lengths.emplace_back(pattern.size());
+            }
+            // bytes that appear in no pattern all share class 0
+            m_classes.fill(0);
+            for (std::string_view pattern : patterns) {
+                for (char ch : pattern) {
+                    m_classes[static_cast<uint8_t>(ch)] = 1;
+                }
+            }
+            m_class_count = 1;
+            for (uint8_t& cls : m_classes) {
+                if (cls) cls = static_cast<uint8_t>(m_class_count++);
+            }
+
+            m_nodes.assign(1, Node {});
+            for (uint32_t index = 0; index < patterns.size(); ++index) {
+                if (patterns[index].empty()) {
+                    continue;
+                }
+                uint32_t node = 0;
+                for (char ch : patterns[index]) {
+                    const uint8_t cls = m_classes[static_cast<uint8_t>(ch)];
+                    auto iter = ranges::find(m_nodes[node].children, cls, &std::pair<uint8_t, uint32_t>::first);
+                    if (iter != m_nodes[node].children.end()) {
+                        node = iter->second;
+                        continue;
+                    }
+                    m_nodes[node].children.emplace_back(cls, static_cast<uint32_t>(m_nodes.size()));
+                    node = static_cast<uint32_t>(m_nodes.size());
+                    m_nodes.emplace_back();
+                }
+                m_nodes[node].pattern = std::min(m_nodes[node].pattern, index);
+            }
+
+            // breadth first, so the fail target of a node is complete before the node itself
+            m_next.assign(m_nodes.size() * m_class_count, 0);
+            std::vector<uint32_t> queue { 0 };
+            for (size_t head = 0; head < queue.size(); ++head) {
+                const uint32_t node = queue[head];
+                Node& current = m_nodes[node];
+                const uint32_t fail = current.fail;
+                if (node != 0) {
+                    std::copy_n(m_next.begin() + fail * m_class_count, m_class_count,
+                                m_next.begin() + node * m_class_count);
+                    current.output = current.pattern != NoPattern ? node : m_nodes[fail].output;
+                    current.next_output = current.pattern != NoPattern ? m_nodes[fail].output : NoPattern;
+                }
+                for (auto [cls, child] : current.children) {
+                    m_nodes[child].fail = node == 0 ? 0 : m_next[fail * m_class_count + cls];
+                    m_next[node * m_class_count + cls] = child;
+                    queue.emplace_back(child);
+                }
+                current.children.clear();
+                current.children.shrink_to_fit();
+            }
+        }
+
+        std::vector<Node> m_nodes;
+        // dense transitions, m_next[state * m_class_count + class]
+        std::vector<uint32_t> m_next;
+        std::array<uint8_t, 256> m_classes {};
+        size_t m_class_count = 1;
+        std::vector<size_t> m_lengths;
+    };
+
+    // Applies a whole replace map in one pass over the string, with an Aho-Corasick automaton built once per map.
+    // The match starting leftmost is replaced first, whatever its place in the map: map order only decides
+    // between `from`s starting at the same position. Scanning goes on after the match, the text it was replaced
+    // with is not scanned again. This differs from applying the pairs one after another with string_replace_all
+    // whenever matches overlap or chain: {"b", "Y"}, {"ab", "X"} turns "ab" into "X" here but "aY" sequentially,
+    // and {"A", "B"}, {"B", "C"} turns "A" into "B" here but "C" sequentially. Empty `from`s are ignored.
+    // Matching is on bytes, so utf8 patterns work as they are.
+    class StringReplacer
+    {
+    public:
+        StringReplacer() = default;
+
+        template <ranges::input_range PairsT>
+        requires(requires(ranges::range_reference_t<PairsT> pair) {
+            std::string_view(pair.first);
+            std::string_view(pair.second);
+        })
+        explicit StringReplacer(const PairsT& replace_map)
+        {
+            std::vector<std::string_view> froms;
+            for (const auto& [from, to] : replace_map) {
+                froms.emplace_back(from);
+                m_tos.emplace_back(to);
+            }
+            m_automaton = AhoCorasick(froms);
+        }
+        StringReplacer(std::initializer_list<std::pair<std::string_view, std::string_view>> replace_map)
+            : StringReplacer(std::vector(replace_map))
+        {}
+
+        bool empty() const noexcept { return m_automaton.empty(); }
+
+        // out is overwritten, its capacity reused
+        void replace(std::string_view str, std::string& out) const
+        {
+            out.clear();
+            if (empty()) {
+                out.append(str);
+                return;
+            }
+            // for every position, the first pattern of the map that starts there
+            constexpr size_t StackSize = 256;
+            uint32_t stack_best[StackSize];
+            std::unique_ptr<uint32_t[]> heap_best;
+            uint32_t* best = stack_best;
+            if (str.size() > StackSize) {
+                heap_best = std::make_unique<uint32_t[]>(str.size());
+                best = heap_best.get();
+            }
+            std::fill_n(best, str.size(), AhoCorasick::NoPattern);
+            m_automaton.scan(str, [&](size_t end, uint32_t pattern) {
+                uint32_t& slot = best[end - m_automaton.pattern_length(pattern)];
+                slot = std::min(slot, pattern);
+                return true;
+            });
+
+            out.reserve(str.size());
+            for (size_t pos = 0; pos < str.size();) {
+                if (best[pos] == AhoCorasick::NoPattern) {
+                    // copy the run up to the next match at once
+                    size_t end = pos + 1;
+                    while (end < str.size() && best[end] == AhoCorasick::NoPattern) {
+                        ++end;
+                    }
+                    out.append(str.substr(pos, end - pos));
+                    pos = end;
+                    continue;
+                }
+                out.append(m_tos[best[pos]]);
+                pos += m_automaton.pattern_length(best[pos]);
+            }
+        }
+
+        [[nodiscard]] std::string replace(std::string_view str) const
+        {
+            std::string result;
+            replace(str, result);
+            return result;
+        }
+
+        void replace_in_place(std::string& str) const
+        {
+            if (empty()) {
+                return;
+            }
+            thread_local std::string buffer;
+            replace(str, buffer);
+            str.swap(buffer);
+        }
+
+    private:
+        AhoCorasick m_automaton;
+        std::vector<std::string> m_tos;
+    };
+
+    inline void string_replace_all_in_place(std::string& str, const StringReplacer& replacer)
+    {
+        replacer.replace_in_place(str);
+    }
+
+    [[nodiscard]] inline std::string string_replace_all(std::string_view str, const StringReplacer& replacer)
+    {
+        return replacer.replace(str);
+    }
+
     template <IsSomeKindOfString StringT, typename CharT = ranges::range_value_t<StringT>,
               typename Pred = decltype([](CharT c) -> bool { return c != ' '; })>
     inline void string_trim(StringT& str, Pred not_space = Pred {})
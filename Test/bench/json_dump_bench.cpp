@@ -0,0 +1,166 @@
+// Serializing callback payloads like the ones AsstMsg messages carry: the streaming dump_to, into a reused
+// buffer or an ostream, against to_string() and against the recursive concatenation to_string() used before.
+//
+// Built from Test/; the benchmarks of this directory have no build target:
+//   g++ -std=c++20 -O2 -DNDEBUG -I 3rdparty/include bench/json_dump_bench.cpp -o json_dump_bench
+//   ./json_dump_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "meojson/json.hpp"
+
+namespace
+{
+    template <typename FuncT>
+    double ns_per(size_t count, FuncT&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        return elapsed.count() / static_cast<double>(count);
+    }
+
+    // to_string() as it was before dump_to: every nested value built as a string of its own and concatenated
+    std::string concat_to_string(const json::value& value)
+    {
+        if (value.is_string()) {
+            return '"' + json::unescape_string(value.as_string()) + '"';
+        }
+        if (value.is_array()) {
+            std::string str { '[' };
+            const auto& arr = value.as_array();
+            for (auto iter = arr.begin(); iter != arr.end();) {
+                str += concat_to_string(*iter);
+                if (++iter != arr.end()) {
+                    str += ',';
+                }
+            }
+            str += ']';
+            return str;
+        }
+        if (value.is_object()) {
+            std::string str { '{' };
+            const auto& obj = value.as_object();
+            for (auto iter = obj.begin(); iter != obj.end();) {
+                const auto& [key, val] = *iter;
+                str += '"' + json::unescape_string(key) + std::string { '"', ':' } + concat_to_string(val);
+                if (++iter != obj.end()) {
+                    str += ',';
+                }
+            }
+            str += '}';
+            return str;
+        }
+        return value.to_string();
+    }
+
+    std::vector<json::value> make_payloads()
+    {
+        std::vector<json::value> payloads;
+        payloads.emplace_back(json::object {
+            { "taskchain", "Fight" },
+            { "taskid", 3 },
+            { "uuid", "a1b2c3d4e5f6" },
+            { "details", json::object { { "task", "StartButton2" }, { "exec_times", 1 }, { "pre_task", "Stage" } } },
+        });
+        payloads.emplace_back(json::object {
+            { "taskchain", "Recruit" },
+            { "class", "asst::ProcessTask" },
+            { "what", "RecruitTagsDetected" },
+            { "details", json::object { { "tags", json::array { "Senior Operator", "DPS", "Healing", "Ranged",
+                                                                "Support" } } } },
+        });
+        json::array drops;
+        for (int i = 0; i < 6; ++i) {
+            drops.emplace_back(json::object {
+                { "itemId", std::to_string(30011 + i) },
+                { "itemName", "Item \"" + std::to_string(i) + "\"" },
+                { "quantity", i * 3 + 1 },
+                { "dropType", "NORMAL_DROP" },
+                { "rect", json::array { 120 + i * 64, 520, 60, 60 } },
+                { "score", 0.8 + i * 0.01 },
+            });
+        }
+        json::object stage { { "stageCode", "1-7" }, { "stageId", "main_01-07" } };
+        payloads.emplace_back(json::object {
+            { "taskchain", "Fight" },
+            { "what", "StageDrops" },
+            { "details",
+              json::object { { "stage", std::move(stage) }, { "stars", 3 }, { "drops", std::move(drops) } } },
+        });
+        return payloads;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+    const auto payloads = make_payloads();
+    size_t bytes = 0;
+    for (const auto& payload : payloads) {
+        if (concat_to_string(payload) != payload.to_string()) {
+            std::printf("concat_to_string and to_string differ on %s\n", payload.to_string().c_str());
+            return 1;
+        }
+        bytes += payload.to_string().size();
+    }
+    std::printf("%zu payloads of %zu bytes in total, %zu iterations\n", payloads.size(), bytes, iterations);
+
+    const size_t count = iterations * payloads.size();
+    size_t checksum = 0;
+    const double concat_ns = ns_per(count, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            for (const auto& payload : payloads) {
+                checksum += concat_to_string(payload).size();
+            }
+        }
+    });
+    const double to_string_ns = ns_per(count, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            for (const auto& payload : payloads) {
+                checksum += payload.to_string().size();
+            }
+        }
+    });
+    std::string buffer;
+    const double dump_to_ns = ns_per(count, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            for (const auto& payload : payloads) {
+                buffer.clear();
+                payload.dump_to(buffer);
+                checksum += buffer.size();
+            }
+        }
+    });
+    std::ostringstream concat_stream;
+    const double concat_stream_ns = ns_per(count, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            for (const auto& payload : payloads) {
+                concat_stream.str({});
+                concat_stream << concat_to_string(payload);
+            }
+        }
+    });
+    std::ostringstream stream;
+    const double stream_ns = ns_per(count, [&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            for (const auto& payload : payloads) {
+                stream.str({});
+                payload.dump_to(stream);
+            }
+        }
+    });
+    std::printf("  concatenation (before)     %7.1f ns/payload\n", concat_ns);
+    std::printf("  to_string()                %7.1f ns/payload\n", to_string_ns);
+    std::printf("  dump_to, reused buffer     %7.1f ns/payload\n", dump_to_ns);
+    std::printf("  concatenation to ostream   %7.1f ns/payload\n", concat_stream_ns);
+    std::printf("  dump_to ostream            %7.1f ns/payload\n", stream_ns);
+    std::printf("  (checksum %zu)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// meojson on numeric-heavy documents, like telemetry: parsing, reading the numbers back and serializing,
+// and the number conversions underneath against the std::stod / std::to_string they replaced.
+//
+// Built from Test/; the benchmarks of this directory have no build target:
+//   g++ -std=c++20 -O2 -DNDEBUG -I 3rdparty/include bench/json_number_bench.cpp -o json_number_bench
+//   ./json_number_bench [records]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "meojson/json.hpp"
+
+namespace
+{
+    template <typename FuncT>
+    double ns_per(size_t count, FuncT&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        return elapsed.count() / static_cast<double>(count);
+    }
+
+    // records of a timestamp, a few counters and measurements with many significant digits
+    json::value make_document(size_t records)
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<long long> counters(0, 1'000'000);
+        std::uniform_real_distribution<double> measurements(-1000.0, 1000.0);
+
+        json::array rows;
+        for (size_t i = 0; i < records; ++i) {
+            json::array values;
+            for (int j = 0; j < 8; ++j) {
+                values.emplace_back(measurements(rng));
+            }
+            rows.emplace_back(json::object {
+                { "time", 1'700'000'000'000LL + static_cast<long long>(i) * 16 },
+                { "frame", static_cast<long long>(i) },
+                { "count", counters(rng) },
+                { "score", measurements(rng) / 1000.0 },
+                { "values", std::move(values) },
+            });
+        }
+        return json::object { { "rows", std::move(rows) } };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+
+    const json::value document = make_document(records);
+    const std::string text = document.to_string();
+    std::printf("%zu records, %zu bytes\n", records, text.size());
+
+    const int rounds = 5;
+    double checksum = 0;
+    size_t number_count = 0;
+    const double parse_ns = ns_per(rounds * text.size(), [&] {
+        for (int i = 0; i < rounds; ++i) {
+            checksum += json::parse(text)->at("rows").as_array().size();
+        }
+    });
+    const auto parsed = json::parse(text).value();
+    const double read_ns = ns_per(1, [&] {
+        for (int i = 0; i < rounds; ++i) {
+            for (const auto& row : parsed.at("rows").as_array()) {
+                checksum += static_cast<double>(row.at("time").as_long_long() + row.at("count").as_long_long());
+                checksum += row.at("score").as_double();
+                for (const auto& value : row.at("values").as_array()) {
+                    checksum += value.as_double();
+                }
+                number_count += 11;
+            }
+        }
+    }) / static_cast<double>(number_count);
+    const double dump_ns = ns_per(rounds * text.size(), [&] {
+        for (int i = 0; i < rounds; ++i) {
+            checksum += static_cast<double>(document.to_string().size());
+        }
+    });
+    std::printf("  parse          %6.2f ns/byte\n", parse_ns);
+    std::printf("  read numbers   %6.2f ns/number\n", read_ns);
+    std::printf("  to_string      %6.2f ns/byte\n", dump_ns);
+
+    // the conversions alone
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    std::vector<double> doubles(200000);
+    std::vector<std::string> texts;
+    texts.reserve(doubles.size());
+    for (double& value : doubles) {
+        value = dist(rng);
+        texts.emplace_back(json::_number_helper::to_chars<std::string>(value));
+    }
+
+    const double stod_ns = ns_per(texts.size(), [&] {
+        for (const auto& str : texts) {
+            checksum += std::stod(str);
+        }
+    });
+    const double from_chars_ns = ns_per(texts.size(), [&] {
+        for (const auto& str : texts) {
+            checksum += json::_number_helper::from_chars<double, char>(str);
+        }
+    });
+    const double to_string_ns = ns_per(doubles.size(), [&] {
+        for (double value : doubles) {
+            checksum += static_cast<double>(std::to_string(value).size());
+        }
+    });
+    const double to_chars_ns = ns_per(doubles.size(), [&] {
+        for (double value : doubles) {
+            checksum += static_cast<double>(json::_number_helper::to_chars<std::string>(value).size());
+        }
+    });
+    std::printf("double conversions, %zu values\n", doubles.size());
+    std::printf("  std::stod       %6.1f ns   from_chars %6.1f ns\n", stod_ns, from_chars_ns);
+    std::printf("  std::to_string  %6.1f ns   to_chars   %6.1f ns\n", to_string_ns, to_chars_ns);
+    size_t lossy = 0;
+    for (double value : doubles) {
+        lossy += std::stod(std::to_string(value)) != value;
+    }
+    std::printf("  std::to_string does not read back to the same value for %zu of them\n", lossy);
+    std::printf("  (checksum %g)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Parsing a resource tree with the compile-time widest trait, now the default packed_bytes_trait_max, against the
+// runtime-dispatched scanners that were the default before, which cost an indirect call per string literal and
+// per whitespace run. The tree is parsed with LF and with CRLF line endings.
+//
+// Built from Test/; the benchmarks of this directory have no build target:
+//   g++ -std=c++20 -O2 -DNDEBUG -I 3rdparty/include bench/json_parse_dispatch_bench.cpp -o json_parse_dispatch_bench
+//   ./json_parse_dispatch_bench [rounds]
+// Add -msse4.1 or -mavx2 to see the static trait with wider vectors.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "meojson/json.hpp"
+
+namespace
+{
+    // 300 task files of about 70 KB each, like the startup loading benchmark writes
+    std::vector<std::string> make_files(const char* newline)
+    {
+        std::vector<std::string> files;
+        for (int file = 0; file < 300; ++file) {
+            std::string content = std::string("{") + newline;
+            for (int task = 0; task < 150; ++task) {
+                const std::string name = "Task" + std::to_string(file) + "_" + std::to_string(task);
+                content += (task == 0 ? "" : std::string(",") + newline) + "    \"" + name + "\": {" + newline;
+                content += std::string("        \"algorithm\": \"OcrDetect\",") + newline;
+                content += std::string("        \"action\": \"ClickSelf\",") + newline;
+                content += "        \"text\": [\"\xE5\xBC\x80\xE5\xA7\x8B\xE8\xA1\x8C\xE5\x8A\xA8\", \"Start\"],";
+                content += newline;
+                content += "        \"roi\": [" + std::to_string(task) + ", 200, 400, 120]," + newline;
+                content += std::string("        \"templThreshold\": 0.8,") + newline;
+                content += std::string("        \"postDelay\": 1000,") + newline;
+                content += std::string("        \"replaceMap\": [[\"O\", \"0\"], [\"l\", \"1\"]],") + newline;
+                content += "        \"next\": [\"" + name + "_Next\", \"Stop\"]," + newline;
+                content += "        \"doc\": \"" + std::string(40, 'x') + "\"" + newline + "    }";
+            }
+            content += std::string(newline) + "}" + newline;
+            files.emplace_back(std::move(content));
+        }
+        return files;
+    }
+
+    template <typename accel_traits>
+    double best_ms(const std::vector<std::string>& files, int rounds, size_t& checksum)
+    {
+        double best = 1e300;
+        for (int i = 0; i < rounds; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            for (const auto& content : files) {
+                checksum += json::parser<std::string, std::string, accel_traits>::parse(content)->as_object().size();
+            }
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                                      .count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 10;
+
+    std::printf("static trait: %d bytes per step, best of %d rounds\n",
+                static_cast<int>(packed_bytes_trait_static_max::step), rounds);
+    size_t checksum = 0;
+    for (const char* newline : { "\n", "\r\n" }) {
+        const auto files = make_files(newline);
+        size_t bytes = 0;
+        for (const auto& content : files) {
+            bytes += content.size();
+            // the scalar trait as the reference
+            if (json::parse(content) != json::parser<std::string, std::string, packed_bytes_trait<4>>::parse(content)) {
+                std::printf("traits disagree\n");
+                return 1;
+            }
+        }
+        const double static_ms = best_ms<packed_bytes_trait_static_max>(files, rounds, checksum);
+#ifdef __packed_bytes_trait_dispatch_available
+        const double dispatch_ms = best_ms<packed_bytes_trait_dispatch>(files, rounds, checksum);
+#else
+        const double dispatch_ms = 0;
+#endif
+        std::printf("%s, %zu files, %.1f MB\n", newline[0] == '\r' ? "CRLF" : "LF", files.size(),
+                    bytes / 1048576.0);
+        std::printf("  static trait (now)        %7.1f ms\n", static_ms);
+        std::printf("  runtime dispatch (before) %7.1f ms\n", dispatch_ms);
+    }
+    std::printf("  (checksum %zu)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Startup loading of a resource tree: every json file under a directory read past its BOM and parsed, with
+// the former triple copy of load_file_without_bom and json::open against the current loaders and FileView.
+//
+// Built from Test/; the benchmarks of this directory have no build target:
+//   g++ -std=c++20 -O2 -DNDEBUG -DASST_USE_RANGES_STL -I MaaTest -I MaaTest/Utils -I 3rdparty/include
+//       bench/load_json_bench.cpp MaaTest/Utils/Platform/PlatformPosix.cpp -o load_json_bench
+//   ./load_json_bench [resource dir] [rounds]
+// Without a directory, a synthetic tree of 300 task files (about 20 MB, half of them with a BOM) is written to
+// the temp directory first.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Utils/JsonMisc.hpp"
+#include "Utils/Locale.hpp"
+
+namespace
+{
+    // load_file_without_bom as it was: ifstream to stringstream, .str(), then an assign to drop the BOM
+    std::string legacy_load_file_without_bom(const std::filesystem::path& path)
+    {
+        std::ifstream ifs(path, std::ios::in);
+        if (!ifs.is_open()) {
+            return {};
+        }
+        std::stringstream iss;
+        iss << ifs.rdbuf();
+        ifs.close();
+        std::string str = iss.str();
+
+        if (str.starts_with("\xEF\xBB\xBF")) {
+            str.assign(str.begin() + 3, str.end());
+        }
+        return str;
+    }
+
+    std::filesystem::path write_synthetic_tree()
+    {
+        const auto dir = std::filesystem::temp_directory_path() / "asst_load_json_bench";
+        std::filesystem::create_directories(dir);
+        for (int file = 0; file < 300; ++file) {
+            std::ofstream ofs(dir / ("tasks_" + std::to_string(file) + ".json"), std::ios::out | std::ios::binary);
+            if (file % 2 == 0) {
+                ofs << "\xEF\xBB\xBF";
+            }
+            ofs << "{\n";
+            for (int task = 0; task < 150; ++task) {
+                const std::string name = "Task" + std::to_string(file) + "_" + std::to_string(task);
+                ofs << (task == 0 ? "" : ",\n") << "    \"" << name << "\": {\n"
+                    << "        \"algorithm\": \"OcrDetect\",\n"
+                    << "        \"action\": \"ClickSelf\",\n"
+                    << "        \"text\": [\"\xE5\xBC\x80\xE5\xA7\x8B\xE8\xA1\x8C\xE5\x8A\xA8\", \"Start\"],\n"
+                    << "        \"roi\": [" << task << ", 200, 400, 120],\n"
+                    << "        \"rectMove\": [0, 0, 0, 0],\n"
+                    << "        \"templThreshold\": 0.8,\n"
+                    << "        \"preDelay\": 500,\n"
+                    << "        \"postDelay\": 1000,\n"
+                    << "        \"replaceMap\": [[\"O\", \"0\"], [\"l\", \"1\"]],\n"
+                    << "        \"next\": [\"" << name << "_Next\", \"Stop\"],\n"
+                    << "        \"onErrorNext\": [\"ReturnToTerminal\"],\n"
+                    << "        \"doc\": \"" << std::string(40, 'x') << "\"\n"
+                    << "    }";
+            }
+            ofs << "\n}\n";
+        }
+        return dir;
+    }
+
+    template <typename FuncT>
+    double ms_of(int rounds, FuncT&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            func();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::filesystem::path dir = argc > 1 ? std::filesystem::path(argv[1]) : write_synthetic_tree();
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::vector<std::filesystem::path> files;
+    uintmax_t total_size = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".json") {
+            files.emplace_back(entry.path());
+            total_size += entry.file_size();
+        }
+    }
+    std::printf("%zu json files, %.1f MB under %s, %d rounds\n", files.size(), total_size / 1048576.0,
+                dir.string().c_str(), rounds);
+
+    // same bytes and the same json from the old and the new loaders; this also warms the page cache
+    for (const auto& path : files) {
+        const std::string content = legacy_load_file_without_bom(path);
+        const auto legacy_json = json::open(path, true);
+        const auto new_json = asst::utils::open_json(path);
+        if (content != asst::utils::load_file_without_bom(path) || content != asst::utils::FileView(path).view() ||
+            legacy_json.has_value() != new_json.has_value() || (legacy_json && *legacy_json != *new_json)) {
+            std::printf("loaders differ on %s\n", path.string().c_str());
+            return 1;
+        }
+    }
+
+    size_t checksum = 0;
+    const double legacy_load_ms = ms_of(rounds, [&] {
+        for (const auto& path : files) {
+            checksum += legacy_load_file_without_bom(path).size();
+        }
+    });
+    const double load_ms = ms_of(rounds, [&] {
+        for (const auto& path : files) {
+            checksum += asst::utils::load_file_without_bom(path).size();
+        }
+    });
+    const double view_ms = ms_of(rounds, [&] {
+        for (const auto& path : files) {
+            checksum += asst::utils::FileView(path).view().size();
+        }
+    });
+    const double legacy_json_ms = ms_of(rounds, [&] {
+        for (const auto& path : files) {
+            checksum += json::open(path, true)->as_object().size();
+        }
+    });
+    const double json_ms = ms_of(rounds, [&] {
+        for (const auto& path : files) {
+            checksum += asst::utils::open_json(path)->as_object().size();
+        }
+    });
+    std::printf("  load_file_without_bom  %8.1f ms (before)  %8.1f ms (now)\n", legacy_load_ms, load_ms);
+    std::printf("  FileView               %8.1f ms\n", view_ms);
+    std::printf("  json::open             %8.1f ms (before)  open_json %8.1f ms (now)\n", legacy_json_ms, json_ms);
+    std::printf("  (checksum %zu)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Collision rate and speed of the Point / Rect hashes, the former XOR hash against std::hash, and of
+// unordered_map against PointMap, on the grid-like coordinates the recognizers produce.
+//
+// Built from Test/ like the other benchmarks of this directory, which have no build target:
+//   g++ -std=c++20 -O2 -DNDEBUG -DASST_USE_RANGES_STL -I MaaTest -I MaaTest/Utils -I 3rdparty/include
+//       bench/point_hash_bench.cpp -o point_hash_bench
+//   ./point_hash_bench [rounds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Common/AsstPointMap.h"
+#include "Common/AsstTypes.h"
+
+namespace
+{
+    // std::hash<Point> and std::hash<Rect> before they were mixed
+    struct XorPointHash
+    {
+        size_t operator()(const asst::Point& point) const noexcept
+        {
+            return std::hash<int>()(point.x) ^ std::hash<int>()(point.y);
+        }
+    };
+    struct XorRectHash
+    {
+        size_t operator()(const asst::Rect& rect) const noexcept
+        {
+            return std::hash<int>()(rect.x) ^ std::hash<int>()(rect.y) ^ std::hash<int>()(rect.width) ^
+                   std::hash<int>()(rect.height);
+        }
+    };
+
+    // share of the elements that do not have a bucket of their own
+    template <typename SetT>
+    double collision_rate(const SetT& set)
+    {
+        size_t occupied = 0;
+        for (size_t bucket = 0; bucket < set.bucket_count(); ++bucket) {
+            occupied += set.bucket_size(bucket) != 0;
+        }
+        return 1.0 - static_cast<double>(occupied) / static_cast<double>(set.size());
+    }
+
+    template <typename FuncT>
+    double seconds_of(FuncT&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::vector<asst::Point> grid(int width, int height, int step)
+    {
+        std::vector<asst::Point> points;
+        for (int y = 0; y < height; y += step) {
+            for (int x = 0; x < width; x += step) {
+                points.emplace_back(x, y);
+            }
+        }
+        return points;
+    }
+
+    // fills the map with every point, then looks every point up; returns a checksum against dead code removal
+    template <typename MapT>
+    size_t fill_and_find(const std::vector<asst::Point>& points)
+    {
+        MapT map;
+        for (size_t i = 0; i < points.size(); ++i) {
+            map[points[i]] = static_cast<int>(i);
+        }
+        size_t sum = 0;
+        for (const auto& point : points) {
+            sum += static_cast<size_t>(map.find(point)->second);
+        }
+        return sum;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    const auto points = grid(720, 720, 3);
+    {
+        std::unordered_set<asst::Point, XorPointHash> xor_set(points.begin(), points.end());
+        std::unordered_set<asst::Point> mixed_set(points.begin(), points.end());
+        std::printf("Point, %zu points on a 3 px grid of 720x720\n", points.size());
+        std::printf("  collision rate  xor %.2f  mixed %.2f\n", collision_rate(xor_set), collision_rate(mixed_set));
+    }
+    {
+        std::vector<asst::Rect> rects;
+        for (const auto& point : grid(720, 720, 12)) {
+            rects.emplace_back(point.x, point.y, 40 + point.x % 60, 40 + point.y % 60);
+        }
+        std::unordered_set<asst::Rect, XorRectHash> xor_set(rects.begin(), rects.end());
+        std::unordered_set<asst::Rect> mixed_set(rects.begin(), rects.end());
+        std::printf("Rect, %zu rects\n", rects.size());
+        std::printf("  collision rate  xor %.2f  mixed %.2f\n", collision_rate(xor_set), collision_rate(mixed_set));
+    }
+
+    const auto screen = grid(640, 360, 1);
+    std::printf("%d rounds of fill and lookup, %zu points on a 640x360 grid\n", rounds, screen.size());
+    size_t checksum = 0;
+    // the xor hash is so slow on a grid that a single round stands for all of them
+    const double xor_time = seconds_of([&] {
+        checksum += fill_and_find<std::unordered_map<asst::Point, int, XorPointHash>>(screen);
+    });
+    const double mixed_time = seconds_of([&] {
+        for (int i = 0; i < rounds; ++i) {
+            checksum += fill_and_find<std::unordered_map<asst::Point, int>>(screen);
+        }
+    });
+    const double point_map_time = seconds_of([&] {
+        for (int i = 0; i < rounds; ++i) {
+            checksum += fill_and_find<asst::PointMap<int>>(screen);
+        }
+    });
+    std::printf("  unordered_map xor    %8.3f s (extrapolated from one round)\n", xor_time * rounds);
+    std::printf("  unordered_map mixed  %8.3f s\n", mixed_time);
+    std::printf("  PointMap             %8.3f s\n", point_map_time);
+    std::printf("  (checksum %zu)\n", checksum);
+    return 0;
+}
@@ -31,6 +31,12 @@ extern "C"
     AsstBool ASSTAPI AsstStop(AsstHandle handle);
     AsstBool ASSTAPI AsstRunning(AsstHandle handle);
 
+    // offline step: writes the binary snapshot of a task json, which is loaded instead of the json while up to date
+    AsstBool ASSTAPI AsstCompileTasks(const char* task_json_path, const char* output_path);
+
+    // name of a message id given to AsstApiCallback, e.g. "TaskChainStart"; nullptr for unknown ids
+    ASSTAPI_PORT const char* ASST_CALL AsstGetMsgName(AsstMsgId msg);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,96 @@
+// json::object stored in a flat_map (MEOJSON_FLAT_OBJECT) against a std::map driven by the same random
+// insertions, erasures and merges: same entries in the same order. Keys must not be assignable through the
+// iterators, which would break the sort order; that part is checked at compile time.
+//
+// Built from Test/; the programs of this directory have no build target and exit with 0 on success:
+//   g++ -std=c++20 -I 3rdparty/include tests/flat_object_test.cpp -o flat_object_test
+//   ./flat_object_test
+
+#define MEOJSON_FLAT_OBJECT
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "meojson/json.hpp"
+
+namespace
+{
+    using iterator = json::object::iterator;
+    using const_iterator = json::object::const_iterator;
+
+    static_assert(std::random_access_iterator<iterator> && std::random_access_iterator<const_iterator>);
+    static_assert(std::is_convertible_v<iterator, const_iterator> && !std::is_convertible_v<const_iterator, iterator>);
+    static_assert(!std::is_assignable_v<decltype((std::declval<iterator>()->first)), std::string>);
+    static_assert(!std::is_assignable_v<decltype((std::get<0>(*std::declval<iterator>()))), std::string>);
+    static_assert(std::is_assignable_v<decltype((std::declval<iterator>()->second)), json::value>);
+    static_assert(!std::is_assignable_v<decltype((std::declval<const_iterator>()->second)), json::value>);
+
+    bool same(const json::object& object, const std::map<std::string, json::value>& expected)
+    {
+        return std::ranges::equal(object, expected, [](const auto& lhs, const auto& rhs) {
+            return lhs.first == rhs.first && lhs.second == rhs.second;
+        });
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(20261019);
+    auto uniform = [&](int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); };
+    auto random_key = [&] { return "key" + std::to_string(uniform(0, 40)); };
+
+    size_t mismatches = 0;
+    for (int round = 0; round < 2000; ++round) {
+        json::object object;
+        std::map<std::string, json::value> expected;
+        for (int step = 0; step < 60; ++step) {
+            const std::string key = random_key();
+            const json::value value = uniform(0, 1) ? json::value(uniform(0, 100)) : json::value(random_key());
+            switch (uniform(0, 4)) {
+            case 0:
+                object.emplace(key, value);
+                expected.emplace(key, value);
+                break;
+            case 1:
+                object[key] = value;
+                expected[key] = value;
+                break;
+            case 2:
+                object.erase(key);
+                expected.erase(key);
+                break;
+            case 3: {
+                // values written through the iterators
+                for (auto&& [name, val] : object) {
+                    if (name == key) {
+                        val = value;
+                    }
+                }
+                if (auto iter = expected.find(key); iter != expected.end()) {
+                    iter->second = value;
+                }
+                break;
+            }
+            default: {
+                json::object other { { key, value }, { random_key(), json::array { step } } };
+                std::map<std::string, json::value> other_expected(other.begin(), other.end());
+                object |= std::move(other);
+                expected.merge(other_expected);
+                break;
+            }
+            }
+        }
+        if (!same(object, expected) || json::object(expected) != object) {
+            ++mismatches;
+            std::printf("mismatch: round %d\n", round);
+        }
+    }
+    std::printf("%zu of 2000 rounds differ from std::map\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// non_max_suppress against a brute-force O(n^2) reference, in both modes and with and without grouping by
+// text, on random dense and sparse results. In Merge mode an absorbed result must grow the best scored kept
+// result overlapping it, whatever the grid the implementation uses.
+//
+// Built from Test/; the programs of this directory have no build target and exit with 0 on success:
+//   g++ -std=c++20 -DASST_USE_RANGES_STL -I MaaTest -I MaaTest/Utils -I 3rdparty/include tests/nms_test.cpp
+//       -o nms_test
+//   ./nms_test
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Common/AsstNms.h"
+
+namespace
+{
+    template <typename SameGroupT>
+    std::vector<asst::TextRect> reference(std::vector<asst::TextRect> results, double iou_threshold,
+                                          asst::NmsMode mode, SameGroupT same_group)
+    {
+        std::vector<size_t> order(results.size());
+        std::iota(order.begin(), order.end(), size_t { 0 });
+        std::ranges::stable_sort(order,
+                                 [&](size_t lhs, size_t rhs) { return results[lhs].score > results[rhs].score; });
+
+        std::vector<size_t> kept;
+        std::vector<asst::Rect> grown;
+        for (size_t index : order) {
+            auto owner = std::ranges::find_if(kept, [&](size_t other) {
+                return same_group(results[other], results[index]) &&
+                       asst::rect_iou(results[other].rect, results[index].rect) > iou_threshold;
+            });
+            if (owner == kept.end()) {
+                kept.emplace_back(index);
+                grown.emplace_back(results[index].rect);
+                continue;
+            }
+            if (mode == asst::NmsMode::Merge) {
+                asst::Rect& target = grown[owner - kept.begin()];
+                const asst::Rect& absorbed = results[index].rect;
+                const int right = std::max(target.x + target.width, absorbed.x + absorbed.width);
+                const int bottom = std::max(target.y + target.height, absorbed.y + absorbed.height);
+                target.x = std::min(target.x, absorbed.x);
+                target.y = std::min(target.y, absorbed.y);
+                target.width = right - target.x;
+                target.height = bottom - target.y;
+            }
+        }
+
+        std::vector<asst::TextRect> expected;
+        for (size_t i = 0; i < kept.size(); ++i) {
+            expected.emplace_back(results[kept[i]]);
+            expected.back().rect = grown[i];
+        }
+        return expected;
+    }
+
+    bool same(const std::vector<asst::TextRect>& lhs, const std::vector<asst::TextRect>& rhs)
+    {
+        return std::ranges::equal(lhs, rhs, [](const asst::TextRect& a, const asst::TextRect& b) {
+            return a.rect == b.rect && a.score == b.score && a.text == b.text;
+        });
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(20261019);
+    auto uniform = [&](int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); };
+
+    const auto same_text = [](const asst::TextRect& lhs, const asst::TextRect& rhs) { return lhs.text == rhs.text; };
+    size_t mismatches = 0;
+    size_t cases = 0;
+    for (int round = 0; round < 3000; ++round) {
+        const int count = uniform(2, 120);
+        const int area = uniform(50, 2000);
+        const int max_size = uniform(5, 200);
+        std::vector<asst::TextRect> results;
+        for (int i = 0; i < count; ++i) {
+            asst::TextRect result;
+            result.rect = asst::Rect(uniform(0, area), uniform(0, area), uniform(1, max_size), uniform(1, max_size));
+            // coarse scores, so that ties happen
+            result.score = uniform(0, 20) / 20.0;
+            result.text = std::string(1, static_cast<char>('a' + uniform(0, 2)));
+            results.emplace_back(std::move(result));
+        }
+        const double threshold = uniform(0, 9) / 10.0;
+
+        for (auto mode : { asst::NmsMode::Suppress, asst::NmsMode::Merge }) {
+            for (bool grouped : { false, true }) {
+                auto actual = results;
+                std::vector<asst::TextRect> expected;
+                if (grouped) {
+                    asst::non_max_suppress(actual, threshold, mode, same_text);
+                    expected = reference(results, threshold, mode, same_text);
+                }
+                else {
+                    asst::non_max_suppress(actual, threshold, mode);
+                    expected = reference(results, threshold, mode, asst::NmsAnyGroup {});
+                }
+                ++cases;
+                if (!same(actual, expected)) {
+                    ++mismatches;
+                    std::printf("mismatch: round %d, %s, %s\n", round,
+                                mode == asst::NmsMode::Merge ? "Merge" : "Suppress", grouped ? "grouped" : "any");
+                }
+            }
+        }
+    }
+    std::printf("%zu of %zu cases differ from the reference\n", mismatches, cases);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// TaskStore hot reload against directory moves: a task directory moved into the watched tree is loaded, one
+// moved out is dropped, and one renamed inside the tree keeps being watched under its new name.
+//
+// Built from Test/; the programs of this directory have no build target and exit with 0 on success:
+//   g++ -std=c++20 -DASST_USE_RANGES_STL -I MaaTest -I MaaTest/Utils -I 3rdparty/include
+//       tests/task_store_watch_test.cpp MaaTest/Utils/Platform/PlatformPosix.cpp -pthread -o task_store_watch_test
+//   ./task_store_watch_test
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "Common/AsstTaskStore.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    void write_task(const fs::path& path, const std::string& name)
+    {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path) << "{ \"" << name << "\": { \"algorithm\": \"JustReturn\" } }";
+    }
+
+    // the watcher reloads in the background, give it some time
+    template <typename PredT>
+    bool eventually(PredT&& pred)
+    {
+        using namespace std::chrono_literals;
+        for (int i = 0; i < 50; ++i) {
+            if (pred()) {
+                return true;
+            }
+            std::this_thread::sleep_for(100ms);
+        }
+        return pred();
+    }
+
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        std::printf("%s  %s\n", condition ? "ok    " : "FAILED", what);
+        failures += !condition;
+    }
+}
+
+int main()
+{
+    const fs::path root = fs::temp_directory_path() / "asst_task_store_watch_test";
+    fs::remove_all(root);
+    const fs::path res = root / "res";
+    write_task(res / "a.json", "TaskA");
+    write_task(res / "d2" / "c.json", "TaskC");
+    write_task(root / "staging" / "sub" / "b.json", "TaskB");
+    fs::create_directories(root / "out");
+
+    asst::TaskStore store;
+    auto has = [&](const char* name) { return store.snapshot()->find(name) != nullptr; };
+    check(store.load(res) && has("TaskA") && has("TaskC") && !has("TaskB"), "initial load");
+    check(store.start_watching(), "start watching");
+
+    fs::rename(root / "staging" / "sub", res / "sub");
+    check(eventually([&] { return has("TaskB"); }), "directory moved in is loaded");
+
+    fs::rename(res / "d2", root / "out" / "d2");
+    check(eventually([&] { return !has("TaskC"); }), "directory moved out is dropped");
+
+    // the moved out directory is not watched anymore
+    write_task(root / "out" / "d2" / "c2.json", "TaskC2");
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    check(!has("TaskC") && !has("TaskC2"), "directory moved out stays dropped");
+
+    fs::rename(res / "sub", res / "sub2");
+    write_task(res / "sub2" / "b2.json", "TaskB2");
+    check(eventually([&] { return has("TaskB") && has("TaskB2"); }), "directory renamed inside is still watched");
+
+    store.stop_watching();
+    fs::remove_all(root);
+    return failures == 0 ? 0 : 1;
+}